@@ -0,0 +1,177 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Attacks.h"
+
+Bitboard Attacks::PawnAttacks[2][64];
+Bitboard Attacks::KnightAttacks[64];
+Bitboard Attacks::KingAttacks[64];
+Attacks::Magic Attacks::RookMagics[64];
+Attacks::Magic Attacks::BishopMagics[64];
+Bitboard Attacks::BetweenBB[64][64];
+Bitboard Attacks::LineBB[64][64];
+
+namespace {
+    // Every rook/bishop blocker subset of every square gets one slot
+    Bitboard RookTable[0x19000];
+    Bitboard BishopTable[0x1480];
+
+    const int RookDirections[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    const int BishopDirections[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+    // xorshift64* generator, only used to search for magics at start-up
+    class PRNG {
+    private:
+        uint64_t s;
+    public:
+        explicit PRNG(uint64_t seed) : s(seed) {}
+        uint64_t rand64() {
+            s ^= s >> 12;
+            s ^= s << 25;
+            s ^= s >> 27;
+            return s * 2685821657736338717ULL;
+        }
+        // Numbers with few set bits make good magic candidates
+        uint64_t sparseRand() {
+            return rand64() & rand64() & rand64();
+        }
+    };
+
+    Bitboard bbFromOffset(int sq, int fileDelta, int rankDelta) {
+        int file = fileOf(sq) + fileDelta;
+        int rank = rankOf(sq) + rankDelta;
+        if (file < 0 || file > 7 || rank < 0 || rank > 7) {
+            return 0;
+        }
+        return squareBB(rank * 8 + file);
+    }
+
+    // Slow ray walk, used to fill the tables
+    Bitboard slidingAttack(const int directions[4][2], int sq, Bitboard occupied) {
+        Bitboard attacks = 0;
+        for (int d = 0; d < 4; d++) {
+            int file = fileOf(sq) + directions[d][0];
+            int rank = rankOf(sq) + directions[d][1];
+            while (file >= 0 && file <= 7 && rank >= 0 && rank <= 7) {
+                Bitboard bb = squareBB(rank * 8 + file);
+                attacks |= bb;
+                if (occupied & bb) {
+                    break;
+                }
+                file += directions[d][0];
+                rank += directions[d][1];
+            }
+        }
+        return attacks;
+    }
+
+    void initMagics(Attacks::Magic magics[], Bitboard table[], const int directions[4][2]) {
+        const uint64_t seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+        static Bitboard occupancy[4096];
+        static Bitboard reference[4096];
+        static int epoch[4096];
+        int attempt = 0;
+        Bitboard* next = table;
+
+        for (int sq = 0; sq < 64; sq++) {
+            Attacks::Magic &m = magics[sq];
+            Bitboard edges = ((RANK_1_BB | RANK_8_BB) & ~(RANK_1_BB << (8 * rankOf(sq))))
+                           | ((FILE_A_BB | FILE_H_BB) & ~(FILE_A_BB << fileOf(sq)));
+            m.mask = slidingAttack(directions, sq, 0) & ~edges;
+            m.shift = 64 - popCount(m.mask);
+            m.attacks = next;
+
+            // Enumerate every subset of the mask (Carry-Rippler trick)
+            int size = 0;
+            Bitboard b = 0;
+            do {
+                occupancy[size] = b;
+                reference[size] = slidingAttack(directions, sq, b);
+#if defined(USE_PEXT)
+                m.attacks[_pext_u64(b, m.mask)] = reference[size];
+#endif
+                size++;
+                b = (b - m.mask) & m.mask;
+            } while (b);
+            next += size;
+
+#if !defined(USE_PEXT)
+            // Try random candidates until one maps every subset without a destructive collision
+            PRNG rng(seeds[rankOf(sq)]);
+            for (int i = 0; i < size; ) {
+                m.magic = 0;
+                while (popCount((m.magic * m.mask) >> 56) < 6) {
+                    m.magic = rng.sparseRand();
+                }
+                attempt++;
+                for (i = 0; i < size; i++) {
+                    unsigned idx = m.index(occupancy[i]);
+                    if (epoch[idx] < attempt) {
+                        epoch[idx] = attempt;
+                        m.attacks[idx] = reference[i];
+                    } else if (m.attacks[idx] != reference[i]) {
+                        break;
+                    }
+                }
+            }
+#endif
+        }
+    }
+}
+
+// Fills every table, run once by init()
+static void buildTables() {
+    using namespace Attacks;
+
+    const int knightOffsets[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+    const int kingOffsets[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+
+    for (int sq = 0; sq < 64; sq++) {
+        PawnAttacks[WHITE][sq] = bbFromOffset(sq, -1, 1) | bbFromOffset(sq, 1, 1);
+        PawnAttacks[BLACK][sq] = bbFromOffset(sq, -1, -1) | bbFromOffset(sq, 1, -1);
+        KnightAttacks[sq] = 0;
+        KingAttacks[sq] = 0;
+        for (int i = 0; i < 8; i++) {
+            KnightAttacks[sq] |= bbFromOffset(sq, knightOffsets[i][0], knightOffsets[i][1]);
+            KingAttacks[sq] |= bbFromOffset(sq, kingOffsets[i][0], kingOffsets[i][1]);
+        }
+    }
+
+    initMagics(RookMagics, RookTable, RookDirections);
+    initMagics(BishopMagics, BishopTable, BishopDirections);
+
+    for (int a = 0; a < 64; a++) {
+        for (int b = 0; b < 64; b++) {
+            BetweenBB[a][b] = 0;
+            LineBB[a][b] = 0;
+            if (a == b) {
+                continue;
+            }
+            if (rook(a, 0) & squareBB(b)) {
+                LineBB[a][b] = (rook(a, 0) & rook(b, 0)) | squareBB(a) | squareBB(b);
+                BetweenBB[a][b] = rook(a, squareBB(b)) & rook(b, squareBB(a));
+            } else if (bishop(a, 0) & squareBB(b)) {
+                LineBB[a][b] = (bishop(a, 0) & bishop(b, 0)) | squareBB(a) | squareBB(b);
+                BetweenBB[a][b] = bishop(a, squareBB(b)) & bishop(b, squareBB(a));
+            }
+        }
+    }
+}
+
+void Attacks::init() {
+    // Function-local statics are initialized exactly once, even with several threads racing here
+    static const bool initialized = (buildTables(), true);
+    (void) initialized;
+}
+
+Bitboard Attacks::piece(ChessPieceType type, int sq, Bitboard occupied) {
+    switch (type) {
+        case KNIGHT: return knight(sq);
+        case BISHOP: return bishop(sq, occupied);
+        case ROOK:   return rook(sq, occupied);
+        case QUEEN:  return queen(sq, occupied);
+        case KING:   return king(sq);
+        default:     return 0;
+    }
+}
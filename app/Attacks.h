@@ -0,0 +1,76 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_ATTACKS_H
+#define EXAMAUTUMN2023_ATTACKS_H
+
+#include "Bitboard.h"
+#include "Position.h"
+
+#if defined(USE_PEXT)
+#include <immintrin.h>
+#endif
+
+/**
+ * Precomputed attack tables. Leaper attacks (pawn, knight, king) are plain
+ * 64-entry lookups, sliding attacks use "fancy" magic bitboards, or the BMI2
+ * PEXT instruction when built with USE_PEXT.
+ * init() must be called before any lookup; it is thread-safe and cheap to call again.
+ */
+namespace Attacks {
+
+    struct Magic {
+        Bitboard mask;      // Relevant blocker squares, board edges excluded
+        Bitboard magic;
+        Bitboard* attacks;  // Slice of the shared attack table for this square
+        unsigned shift;
+
+        unsigned index(Bitboard occupied) const {
+#if defined(USE_PEXT)
+            return (unsigned) _pext_u64(occupied, mask);
+#else
+            return (unsigned) (((occupied & mask) * magic) >> shift);
+#endif
+        }
+    };
+
+    extern Bitboard PawnAttacks[2][64];
+    extern Bitboard KnightAttacks[64];
+    extern Bitboard KingAttacks[64];
+    extern Magic RookMagics[64];
+    extern Magic BishopMagics[64];
+    extern Bitboard BetweenBB[64][64];
+    extern Bitboard LineBB[64][64];
+
+    void init();
+
+    inline Bitboard pawn(Color color, int sq) { return PawnAttacks[color][sq]; }
+    inline Bitboard knight(int sq) { return KnightAttacks[sq]; }
+    inline Bitboard king(int sq) { return KingAttacks[sq]; }
+
+    inline Bitboard rook(int sq, Bitboard occupied) {
+        const Magic &m = RookMagics[sq];
+        return m.attacks[m.index(occupied)];
+    }
+
+    inline Bitboard bishop(int sq, Bitboard occupied) {
+        const Magic &m = BishopMagics[sq];
+        return m.attacks[m.index(occupied)];
+    }
+
+    inline Bitboard queen(int sq, Bitboard occupied) {
+        return rook(sq, occupied) | bishop(sq, occupied);
+    }
+
+    // Squares strictly between a and b if they share a rank, file or diagonal, otherwise empty
+    inline Bitboard between(int a, int b) { return BetweenBB[a][b]; }
+
+    // The whole rank, file or diagonal through a and b, or empty if they are not aligned
+    inline Bitboard line(int a, int b) { return LineBB[a][b]; }
+
+    // Attacks of a non-pawn piece type from sq
+    Bitboard piece(ChessPieceType type, int sq, Bitboard occupied);
+}
+
+#endif //EXAMAUTUMN2023_ATTACKS_H
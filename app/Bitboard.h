@@ -0,0 +1,59 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_BITBOARD_H
+#define EXAMAUTUMN2023_BITBOARD_H
+
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// One bit per square, bit 0 = a1, bit 63 = h8 (same numbering as ChessPiece::getPos)
+typedef uint64_t Bitboard;
+
+constexpr Bitboard FILE_A_BB = 0x0101010101010101ULL;
+constexpr Bitboard FILE_H_BB = FILE_A_BB << 7;
+constexpr Bitboard RANK_1_BB = 0xFFULL;
+constexpr Bitboard RANK_8_BB = RANK_1_BB << 56;
+
+constexpr Bitboard squareBB(int sq) {
+    return 1ULL << sq;
+}
+
+constexpr int fileOf(int sq) {
+    return sq & 7;
+}
+
+constexpr int rankOf(int sq) {
+    return sq >> 3;
+}
+
+inline int popCount(Bitboard b) {
+#if defined(_MSC_VER)
+    return (int) __popcnt64(b);
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// Index of the least significant set bit. b must not be empty.
+inline int lsb(Bitboard b) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, b);
+    return (int) idx;
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+// Removes the least significant set bit from b and returns its index
+inline int popLsb(Bitboard &b) {
+    int sq = lsb(b);
+    b &= b - 1;
+    return sq;
+}
+
+#endif //EXAMAUTUMN2023_BITBOARD_H
@@ -0,0 +1,99 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_BOOK_H
+#define EXAMAUTUMN2023_BOOK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "Move.h"
+#include "Position.h"
+
+struct BookMove {
+    Move move;
+    int weight;
+};
+
+/**
+ * Opening book in the Polyglot layout: 16 byte big-endian entries of
+ * key, move, weight and learn data, sorted by key, several entries per
+ * position. Moves use Polyglot's encoding (to, from, promotion piece,
+ * castling as the king taking its own rook) and keys are Polyglot's
+ * (polyglotKey), so books of other programs and books built with chess-book
+ * work in both directions.
+ *
+ * The file is used in place from a memory mapping. Keys are uniformly
+ * distributed, so a lookup is an interpolation search that narrows to a
+ * binary search, a handful of probes even in books of millions of entries.
+ */
+class OpeningBook {
+private:
+    MappedFile file;
+    const unsigned char* entries = nullptr;
+    size_t count = 0;
+    std::string error;
+
+    uint64_t keyAt(size_t i) const;
+    // First entry with a key not below key
+    size_t lowerBound(uint64_t key) const;
+
+public:
+    static constexpr size_t ENTRY_SIZE = 16;
+
+    // Fails on a missing file, one that is not a whole number of entries or a stale chess-book book
+    bool open(const std::string &path);
+    // Why the last open() failed
+    const std::string &lastError() const { return error; }
+    void close();
+    bool isOpen() const { return entries != nullptr; }
+    size_t size() const { return count; }
+
+    // Appends the legal book moves for pos to moves; returns how many there were
+    int probe(const Position &pos, std::vector<BookMove> &moves) const;
+    /**
+     * Picks one of pos's book moves with a probability proportional to its weight.
+     * @param random - any 64-bit random number, the caller owns the generator
+     * @return NO_MOVE when pos is not in the book
+     */
+    Move pick(const Position &pos, uint64_t random) const;
+
+    // Polyglot's 16-bit form of a move and back. fromPolyglot returns NO_MOVE if no legal move matches
+    static uint16_t toPolyglot(Move m);
+    static Move fromPolyglot(const Position &pos, uint16_t move);
+};
+
+/**
+ * Polyglot's key of a position: its Random64 numbers for every piece on its square, the castling
+ * rights, the en passant file if a pawn of the side to move stands next to the pawn that just
+ * advanced two squares, and white to move. Unrelated to the engine's own Position::hash().
+ */
+uint64_t polyglotKey(const Position &pos);
+
+/**
+ * Collects weighted moves and writes them out as a sorted book.
+ * Weights above what an entry holds are scaled down for the whole book.
+ */
+class BookWriter {
+private:
+    struct Entry {
+        uint64_t key;
+        uint16_t move;
+        uint64_t weight;
+    };
+    std::vector<Entry> pending;
+
+public:
+    // Weights of the same move in the same position add up
+    void add(const Position &pos, Move m, uint64_t weight);
+    size_t size() const { return pending.size(); }
+    /**
+     * Merges duplicates, drops moves below minWeight in total and writes the book.
+     * @return the number of entries written, or -1 if path cannot be written
+     */
+    long long write(const std::string &path, uint64_t minWeight = 1);
+};
+
+#endif //EXAMAUTUMN2023_BOOK_H
@@ -8,6 +8,9 @@
 #include <glm/ext/matrix_transform.hpp>
 #include <thread>
 #include <bitset>
+#include <chrono>
+#include <future>
+#include <vector>
 #include "ChessApp.h"
 #include "Shader.h"
 #include "GeometricTools.h"
@@ -15,6 +18,7 @@
 #include "VertexBuffer.h"
 #include "BufferLayout.h"
 #include "VertexArray.h"
+#include "UniformBuffer.h"
 #include "RenderCommands.h"
 #include "PerspectiveCamera.h"
 #include "shaders.h"
@@ -23,14 +27,41 @@
 #include "iomanip"
 #include "ChessEngine.h"
 #include "ChessPiece.h"
-#include "tiny_obj_loader.h"
+#include "Mesh.h"
+#include "ThreadPool.h"
 
-struct Vertex
+/**
+ * Per-instance data of a chess piece, read by pieceVertexShader with a divisor of 1.
+ * Instances are grouped by piece type so that each type is one contiguous range
+ * of the instance buffer and one instanced draw.
+ */
+struct PieceInstance
+{
+    glm::mat4 model;
+    glm::vec4 color;
+    glm::vec2 flags;    // x: white piece, y: selected
+};
+
+/**
+ * CPU side of the FrameData uniform block in shaders.h, uploaded once per frame.
+ * Each vec3 is followed by a float so that the members land on std140 offsets.
+ */
+struct FrameUniforms
 {
-    glm::vec3 location;
-    glm::vec3 normals;
-    glm::vec2 texCoords;
+    glm::mat4 viewMat;
+    glm::mat4 projMat;
+    glm::mat4 viewProjMat;
+    glm::vec3 cameraPosition;
+    float diffuseStrength;
+    glm::vec3 lightSourcePosition;
+    float specularStrength;
+    glm::vec3 lightColor;
+    float padding;
 };
+static_assert(sizeof(FrameUniforms) == 240, "FrameUniforms must match the std140 layout of FrameData");
+
+const int PIECE_TYPES = KING + 1;
+const int MAX_PIECES = 64;          // One piece per square at most
 
 
 std::vector<glm::vec3> gridPos;     //Grid coordinates
@@ -53,6 +84,7 @@ float ChessApp::specStrength = 0.5;
 float ChessApp::diffStrength = 1.0;
 Shader* ChessApp::cubeShader = nullptr;
 Shader* ChessApp::gridShader = nullptr;
+Shader* ChessApp::pieceShader = nullptr;
 ChessEngine* ChessApp::chessEngine = new ChessEngine();
 
 
@@ -76,7 +108,9 @@ void GLAPIENTRY MessageCallback(GLenum source,
 }
 
 
-GLuint LoadModel(std::string path, std::string filename, int& size);
+std::shared_ptr<VertexArray> UploadModel(const MeshVertex* vertices, size_t vertexCount, const uint32_t* indices,
+                                         size_t indexCount, const std::shared_ptr<VertexBuffer>& instanceVB);
+Mesh PlaceholderMesh(float width, float height);
 
 /**
  * Constructor
@@ -130,10 +164,21 @@ void ChessApp::keyCallback(GLFWwindow *window, int key, int scancode, int action
         case GLFW_KEY_H: hiRes = !hiRes; printf("%s\n",hiRes ? "Hi" : "Low"); break;
         // Reset board:
         case GLFW_KEY_R: chessEngine->resetBoard(); playerPos = glm::vec2(0); break;
+        // Take back the last move:
+        case GLFW_KEY_U: chessEngine->undoMove(); break;
         // Stop/Resume day night cycle (NB: Does not reset cycle, it continues, only change is if "sun" position updates)
         case GLFW_KEY_SPACE:
             chessEngine->tryMove(playerPos.x * 8 + playerPos.y);
             break;
+        // Cycle the piece pawns promote to: Queen -> Rook -> Bishop -> Knight
+        case GLFW_KEY_P:
+            switch(chessEngine->getPromotionType()){
+                case QUEEN:  chessEngine->setPromotionType(ROOK); printf("Promote to Rook\n"); break;
+                case ROOK:   chessEngine->setPromotionType(BISHOP); printf("Promote to Bishop\n"); break;
+                case BISHOP: chessEngine->setPromotionType(KNIGHT); printf("Promote to Knight\n"); break;
+                default:     chessEngine->setPromotionType(QUEEN); printf("Promote to Queen\n"); break;
+            }
+            break;
         case GLFW_KEY_ENTER: holdKey = !holdKey; break;
         default: break;
     }
@@ -159,9 +204,38 @@ unsigned int ChessApp::Run() const{
         return -1;
     }
     const std::string TEXTURES_DIR = "resources/textures/";
+    const std::string MODELS_DIR = "resources/models/";
+    double runStart = glfwGetTime();
 
     bool running = true;
 
+    // Models and textures are read and decoded by worker threads while the first frames are drawn,
+    // this thread only uploads them once they are ready
+    const char* modelNames[PIECE_TYPES] = {"Pawn_hi", "Rook_hi", "Knight_hi", "Bishop_hi", "Queen_hi", "King_hi"};
+    ThreadPool loaders(std::min(8u, std::thread::hardware_concurrency()));
+    std::future<std::unique_ptr<MeshAsset>> modelJobs[PIECE_TYPES];
+    for (int type = 0; type < PIECE_TYPES; type++) {
+        std::string name = MODELS_DIR + modelNames[type];
+        modelJobs[type] = loaders.submit([name] {
+            auto asset = std::make_unique<MeshAsset>();
+            if (!asset->load(name + ".obj", name + ".mesh")) {
+                asset.reset();
+            }
+            return asset;
+        });
+    }
+    // Each image is decoded once and used both as a floor texture and as a cube map
+    std::future<TextureManager::Image> darkWoodJob = loaders.submit([TEXTURES_DIR] {
+        return TextureManager::DecodeImageRGBA(TEXTURES_DIR + "dark_wood.png");
+    });
+    std::future<TextureManager::Image> lightWoodJob = loaders.submit([TEXTURES_DIR] {
+        return TextureManager::DecodeImageRGBA(TEXTURES_DIR + "light_wood.png");
+    });
+    int pendingAssets = PIECE_TYPES + 2;
+    int texturesLoaded = 0;         // Wood images uploaded as both floor texture and cube map
+    bool texturesReady = false;     // Sampling unloaded textures gives black, so they stay off until both woods are in
+    bool firstFrame = true;
+
     //Enable detailed messages for debug and depth test
     glEnable(GL_DEBUG_OUTPUT);
     glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
@@ -175,21 +249,29 @@ unsigned int ChessApp::Run() const{
     glm::vec4 whiteCol = glm::vec4(base*210, base*180, base*140, 1.0f);
 
 
-    //Load chess piece models
-    int pawnSize = 0;
-    auto pawnVAO = LoadModel("resources/models/", "Pawn_hi", pawnSize);
-    int rookSize = 0;
-    auto rookVAO = LoadModel("resources/models/", "Rook_hi", rookSize);
-    int knightSize = 0;
-    auto knightVAO = LoadModel("resources/models/", "Knight_hi", knightSize);
-    int bishopSize = 0;
-    auto bishopVAO = LoadModel("resources/models/", "Bishop_hi", bishopSize);
-    int queenSize = 0;
-    auto queenVAO = LoadModel("resources/models/", "Queen_hi", queenSize);
-    int kingSize = 0;
-    auto kingVAO = LoadModel("resources/models/", "King_hi", kingSize);
-
-
+    // One instance buffer shared by all piece models, each type draws its own range of it
+    std::shared_ptr<VertexBuffer> instanceVB = std::make_shared<VertexBuffer>(nullptr, sizeof(PieceInstance) * MAX_PIECES, GL_DYNAMIC_DRAW);
+    instanceVB->SetLayout(BufferLayout({
+                                               {ShaderDataType::Mat4, "model"}, {ShaderDataType::Float4, "color"}, {ShaderDataType::Float2, "flags"}
+                                       }));
+    instanceVB->SetDivisor(1);
+
+    // Chess piece models, indexed by ChessPieceType. Boxes of about the piece's size stand in until a model is loaded
+    const float placeholderHeights[PIECE_TYPES] = {18.6f, 19.2f, 26.9f, 29.3f, 33.9f, 40.9f};
+    std::shared_ptr<VertexArray> pieceVA[PIECE_TYPES];
+    for (int type = 0; type < PIECE_TYPES; type++) {
+        Mesh placeholder = PlaceholderMesh(11.0f, placeholderHeights[type]);
+        pieceVA[type] = UploadModel(placeholder.vertices.data(), placeholder.vertices.size(),
+                                    placeholder.indices.data(), placeholder.indices.size(), instanceVB);
+    }
+    std::vector<PieceInstance> instances;
+    instances.reserve(MAX_PIECES);
+    int instanceFirst[PIECE_TYPES] = {};
+    int instanceCount[PIECE_TYPES] = {};
+    // The instance buffer is rebuilt only when the position or the selection changes
+    uint64_t uploadedHash = 0;
+    const ChessPiece* uploadedSelection = nullptr;
+    bool instancesValid = false;
 
     // Create grid and cube geometry
     auto gridVertices = GeometricTools::UnitGridGeometry2D(X, Y);
@@ -250,18 +332,17 @@ unsigned int ChessApp::Run() const{
     //Load shaders
     gridShader = new Shader(gridVertexShader, gridFragmentShader);
     cubeShader = new Shader(cubeVertexShader, cubeFragmentShader);
+    pieceShader = new Shader(pieceVertexShader, pieceFragmentShader);
+    // Camera and light uniforms shared by all three shaders
+    std::shared_ptr<UniformBuffer> frameUB = std::make_shared<UniformBuffer>(sizeof(FrameUniforms), 0);
+    FrameUniforms frameUniforms;
     gridShader->use();
 
     //Set background color
     glm::vec4 bColor = glm::vec4(0.2f,0.2f,0.2f,1.0f);
     RenderCommands::SetClearColor(bColor);
 
-    //Load textures
     TextureManager* textureManager = TextureManager::GetInstance();
-    textureManager->LoadTexture2DRGBA("floor_dark", std::string(TEXTURES_DIR) + std::string("dark_wood.png"),0);
-    textureManager->LoadTexture2DRGBA("floor_light", std::string(TEXTURES_DIR) + std::string("light_wood.png"),1);
-    textureManager->LoadCubeMapRGBA("dark_cubemap", std::string(TEXTURES_DIR) + std::string("dark_wood.png"),2);
-    textureManager->LoadCubeMapRGBA("light_cubemap", std::string(TEXTURES_DIR) + std::string("light_wood.png"),3);
 
     float startTime = glfwGetTime();
     float elapsedTime;
@@ -280,6 +361,50 @@ unsigned int ChessApp::Run() const{
     glfwSetKeyCallback(window, keyCallback);
     do
     {
+        // Upload whatever the loaders finished since the last frame
+        if (pendingAssets > 0) {
+            auto ready = [](const auto& job) {
+                return job.valid() && job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            };
+            for (int type = 0; type < PIECE_TYPES; type++) {
+                if (!ready(modelJobs[type])) {
+                    continue;
+                }
+                // A model that failed to load keeps its placeholder
+                std::unique_ptr<MeshAsset> asset = modelJobs[type].get();
+                if (asset) {
+                    pieceVA[type] = UploadModel(asset->vertices(), asset->vertexCount(), asset->indices(),
+                                                asset->indexCount(), instanceVB);
+                }
+                pendingAssets--;
+            }
+            // An image that failed to decode leaves textures off for good rather than sampling a missing one
+            if (ready(darkWoodJob)) {
+                TextureManager::Image image = darkWoodJob.get();
+                if (textureManager->LoadTexture2DRGBA("floor_dark", image, 0)
+                    && textureManager->LoadCubeMapRGBA("dark_cubemap", image, 2)) {
+                    texturesLoaded++;
+                } else {
+                    std::cout << "Could not load " << TEXTURES_DIR << "dark_wood.png" << std::endl;
+                }
+                pendingAssets--;
+            }
+            if (ready(lightWoodJob)) {
+                TextureManager::Image image = lightWoodJob.get();
+                if (textureManager->LoadTexture2DRGBA("floor_light", image, 1)
+                    && textureManager->LoadCubeMapRGBA("light_cubemap", image, 3)) {
+                    texturesLoaded++;
+                } else {
+                    std::cout << "Could not load " << TEXTURES_DIR << "light_wood.png" << std::endl;
+                }
+                pendingAssets--;
+            }
+            texturesReady = texturesLoaded == 2;
+            if (pendingAssets == 0) {
+                std::cout << "All assets loaded after " << (int)((glfwGetTime() - runStart) * 1000) << " ms" << std::endl;
+            }
+        }
+
         RenderCommands::Clear();
         // Get the current time
         float currentTime = glfwGetTime();
@@ -343,19 +468,23 @@ unsigned int ChessApp::Run() const{
         highOld = highlightedTilesHigh;
         lowOld = highlightedTilesLow;
 
+        // Update the uniforms every shader shares
+        frameUniforms.viewMat = camera->GetViewMatrix();
+        frameUniforms.projMat = camera->GetProjectionMatrix();
+        frameUniforms.viewProjMat = camera->GetViewProjectionMatrix();
+        frameUniforms.cameraPosition = camera->GetPosition();
+        frameUniforms.diffuseStrength = diffStrength * lightIntensity;  // multiply by light intensity so that there is no light when the sun is down
+        frameUniforms.lightSourcePosition = lightPosition;
+        frameUniforms.specularStrength = specStrength * lightIntensity; // multiply by light intensity so that there is no light when the sun is down
+        frameUniforms.lightColor = lightColor;
+        frameUB->BufferSubData(0, sizeof(FrameUniforms), &frameUniforms);
+
         //Send uniforms to grid shader
         gridShader->use();
-        gridShader->setMat4("u_viewMat", camera->GetViewMatrix());
-        gridShader->setMat4("u_projMat", camera->GetProjectionMatrix());
         gridShader->setMat4("u_modMat", model);
-        gridShader->setInt("u_texture", texture ? 1 : 0); // Convert bool to int (not strictly needed since true == 1 && false == 0)
+        gridShader->setInt("u_texture", texture && texturesReady ? 1 : 0); // Convert bool to int (not strictly needed since true == 1 && false == 0)
         gridShader->setFloat("u_ambientStrength", ambientLight);
-        gridShader->setUniform3f("u_lightSourcePosition", lightPosition);
-        gridShader->setFloat("u_diffuseStrength", diffStrength * lightIntensity);
-        gridShader->setFloat("u_specularStrength", specStrength * lightIntensity);
-        gridShader->setUniform3f("u_cameraPosition", camera->GetPosition());
         gridShader->setUniform3f("u_normals", glm::vec3(0, 1, 0));
-        gridShader->setUniform3f("u_lightColor", lightColor);
         //gridShader->setUInt("u_highlightedHigh", highlightedTilesHigh);
         //gridShader->setUInt("u_highlightedLow", highlightedTilesLow);
         // Draw the grid
@@ -378,13 +507,7 @@ unsigned int ChessApp::Run() const{
         // Send uniforms to cube shader
         cubeShader->setMat4("u_model", model);
         cubeShader->setUniform4f("u_cubeColor", glm::vec4(glm::vec3(1, 1, 0), lightIntensity));
-        cubeShader->setMat4("u_viewProjMat", camera->GetViewProjectionMatrix());
         cubeShader->setFloat("u_ambientStrength", 1); // Always full intensity since it is a light source
-        cubeShader->setUniform3f("u_lightSourcePosition", lightPosition);
-        cubeShader->setFloat("u_diffuseStrength", diffStrength * lightIntensity); // multiply by light intensity so that there is no light when the sun is down
-        cubeShader->setFloat("u_specularStrength", specStrength * lightIntensity); // multiply by light intensity so that there is no light when the sun is down
-        cubeShader->setUniform3f("u_cameraPosition", camera->GetPosition());
-        cubeShader->setUniform3f("u_lightColor", lightColor);
         cubeShader->setInt("u_texture", 0); //No texture for light
         cubeShader->setInt("u_shine", 1);
         // Draw cube
@@ -392,63 +515,64 @@ unsigned int ChessApp::Run() const{
         RenderCommands::DrawIndex(cubeVA, GL_TRIANGLES);
         cubeVA->Unbind();
 
-        // Set the color for chess pieces
-        cubeShader->setFloat("u_ambientStrength", ambientLight); // Based on sun height
-        cubeShader->setInt("u_texture", texture ? 1 : 0);       // Convert bool to int (not strictly needed)
-        cubeShader->setInt("u_shine", 5);
-        //Draw walls
-        for (const auto &piece: chessEngine->getPieces()) {
-            cubeShader->setUniform4f("u_cubeColor", piece->isWhite() ? whiteCol : blackCol);
-            cubeShader->setBool("u_whitePiece", piece->isWhite());
-
-            if(piece == chessEngine->getSelectedPiece()){
-                cubeShader->setUniform4f("u_cubeColor", glm::vec4(0.2,0.7,0.8,1));
+        // Regroup the pieces by type and upload them if the board changed since the last upload
+        uint64_t boardHash = chessEngine->getPosition().hash();
+        const ChessPiece* selection = chessEngine->getSelectedPiece();
+        if (!instancesValid || boardHash != uploadedHash || selection != uploadedSelection) {
+            std::vector<ChessPiece*> pieces = chessEngine->getPieces();
+            std::fill(instanceCount, instanceCount + PIECE_TYPES, 0);
+            for (ChessPiece* piece : pieces) {
+                instanceCount[piece->getType()]++;
             }
-            // Translate position of piece
-            translationMatrix = glm::translate(glm::mat4(1.0f), gridPos[piece->getPos()]);
-            rotationAngle = piece->isWhite() ? 90.0f : -90.0f;
-            // Rotate piece
-            rotationMatrix = glm::rotate(glm::mat4(1.0f), glm::radians(rotationAngle), glm::vec3(0,1,0));
-            // Scale piece
-            scaleFactor = 0.0075;
-            scaleMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(scaleFactor));
-            // Combine the translation, rotation and scale
-            model = translationMatrix * rotationMatrix * scaleMatrix;
-
-            // Send model matrix to cube shader
-            cubeShader->setMat4("u_model", model);
-            switch(piece->getType()){
-                case PAWN:
-                    glBindVertexArray(pawnVAO);
-                    glDrawArrays(GL_TRIANGLES, 0, pawnSize);
-                    break;
-                case ROOK:
-                    glBindVertexArray(rookVAO);
-                    glDrawArrays(GL_TRIANGLES, 0, rookSize);
-                    break;
-                case KNIGHT:
-                    glBindVertexArray(knightVAO);
-                    glDrawArrays(GL_TRIANGLES, 0, knightSize);
-                    break;
-                case BISHOP:
-                    glBindVertexArray(bishopVAO);
-                    glDrawArrays(GL_TRIANGLES, 0, bishopSize);
-                    break;
-                case QUEEN:
-                    glBindVertexArray(queenVAO);
-                    glDrawArrays(GL_TRIANGLES, 0, queenSize);
-                    break;
-                case KING:
-                    glBindVertexArray(kingVAO);
-                    glDrawArrays(GL_TRIANGLES, 0, kingSize);
-                    break;
-                default:
-                    break;
+            int first = 0;
+            for (int type = 0; type < PIECE_TYPES; type++) {
+                instanceFirst[type] = first;
+                first += instanceCount[type];
             }
-            glBindVertexArray(0);
+            instances.resize(pieces.size());
+            int next[PIECE_TYPES];
+            std::copy(instanceFirst, instanceFirst + PIECE_TYPES, next);
+            for (ChessPiece* piece : pieces) {
+                // Translate, rotate towards the opponent and scale the model down to a square
+                translationMatrix = glm::translate(glm::mat4(1.0f), gridPos[piece->getPos()]);
+                rotationAngle = piece->isWhite() ? 90.0f : -90.0f;
+                rotationMatrix = glm::rotate(glm::mat4(1.0f), glm::radians(rotationAngle), glm::vec3(0,1,0));
+                scaleMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(0.0075f));
+
+                PieceInstance& instance = instances[next[piece->getType()]++];
+                instance.model = translationMatrix * rotationMatrix * scaleMatrix;
+                instance.color = piece->isWhite() ? whiteCol : blackCol;
+                instance.flags = glm::vec2(piece->isWhite() ? 1.0f : 0.0f, piece == selection ? 1.0f : 0.0f);
+            }
+            instanceVB->Bind();
+            instanceVB->BufferSubData(0, sizeof(PieceInstance) * instances.size(), instances.data());
+            instanceVB->Unbind();
+            uploadedHash = boardHash;
+            uploadedSelection = selection;
+            instancesValid = true;
+        }
+
+        // Send uniforms to piece shader
+        pieceShader->use();
+        pieceShader->setUniform4f("u_selectedColor", glm::vec4(0.2,0.7,0.8,1));
+        pieceShader->setFloat("u_ambientStrength", ambientLight); // Based on sun height
+        pieceShader->setInt("u_texture", texture && texturesReady ? 1 : 0);       // Convert bool to int (not strictly needed)
+        pieceShader->setInt("u_shine", 5);
+        // Draw all pieces of a type at once
+        for (int type = 0; type < PIECE_TYPES; type++) {
+            if (instanceCount[type] == 0 || !pieceVA[type]) {
+                continue;
+            }
+            pieceVA[type]->Bind();
+            RenderCommands::DrawIndexInstanced(pieceVA[type], GL_TRIANGLES, instanceCount[type], instanceFirst[type]);
+            pieceVA[type]->Unbind();
         }
 
         glfwSwapBuffers(window);
+        if (firstFrame) {
+            std::cout << "First frame after " << (int)((glfwGetTime() - runStart) * 1000) << " ms" << std::endl;
+            firstFrame = false;
+        }
         glfwPollEvents();
 
         running &= (glfwGetKey(window, GLFW_KEY_Q) == GLFW_RELEASE);
@@ -458,8 +582,16 @@ unsigned int ChessApp::Run() const{
     delete camera;
     delete cubeShader;
     delete gridShader;
+    delete pieceShader;
 
     //Resetting shared_ptr so that destructor is called before GLFW terminates
+    frameUB.reset();
+
+    for (auto& va : pieceVA) {
+        va.reset();
+    }
+    instanceVB.reset();
+
     cubeVA.reset();
     cubeVB.reset();
     cubeIB.reset();
@@ -474,81 +606,53 @@ unsigned int ChessApp::Run() const{
     return 0;
 }
 
-GLuint LoadModel(const std::string path, const std::string filename, int& size)
+/**
+ * Uploads a model into a vertex array with a vertex and an index buffer, and adds the
+ * shared per-instance attributes after the vertex attributes.
+ * @param vertices - vertices in MeshVertex layout
+ * @param indices - triangle list
+ * @param instanceVB - buffer of PieceInstance structs
+ * @return the vertex array
+ */
+std::shared_ptr<VertexArray> UploadModel(const MeshVertex* vertices, size_t vertexCount, const uint32_t* indices,
+                                         size_t indexCount, const std::shared_ptr<VertexBuffer>& instanceVB)
 {
-    //We create a vector of Vertex structs. OpenGL can understand these, and so will accept them as input.
-    std::vector<Vertex> vertices;
-
-    //Some variables that we are going to use to store data from tinyObj
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials; //This one goes unused for now, seeing as we don't need materials for this model.
-
-    //Some variables incase there is something wrong with our obj file
-    std::string warn;
-    std::string err;
-
-
-    //We use tinobj to load our models. Feel free to find other .obj files and see if you can load them.
-    tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, (path + filename + ".obj").c_str(), path.c_str());
-
-    if (!warn.empty()) {
-        std::cout << warn << std::endl;
-    }
-
-    if (!err.empty()) {
-        std::cerr << err << std::endl;
-    }
-
-    //For each shape defined in the obj file
-    for (const auto& shape : shapes)
-    {
-        //We find each mesh
-        for (auto meshIndex : shape.mesh.indices)
-        {
-            //And store the data for each vertice, including normals
-            glm::vec3 vertice = {
-                    attrib.vertices[meshIndex.vertex_index * 3],
-                    attrib.vertices[(meshIndex.vertex_index * 3) + 1],
-                    attrib.vertices[(meshIndex.vertex_index * 3) + 2]
-            };
-            glm::vec3 normal = {
-                    attrib.normals[meshIndex.normal_index * 3],
-                    attrib.normals[(meshIndex.normal_index * 3) + 1],
-                    attrib.normals[(meshIndex.normal_index * 3) + 2]
-            };
-            glm::vec2 textureCoordinate = {                         //These go unnused, but if you want textures, you will need them.
-                    attrib.texcoords[meshIndex.texcoord_index * 2],
-                    attrib.texcoords[(meshIndex.texcoord_index * 2) + 1]
-            };
-
-            vertices.push_back({ vertice, normal, textureCoordinate }); //We add our new vertice struct to our vector
+    std::shared_ptr<VertexBuffer> modelVB = std::make_shared<VertexBuffer>(vertices, sizeof(MeshVertex) * vertexCount);
+    std::shared_ptr<IndexBuffer> modelIB = std::make_shared<IndexBuffer>(indices, indexCount);
+    std::shared_ptr<VertexArray> modelVA = std::make_shared<VertexArray>();
+
+    // Same order as MeshVertex
+    modelVA->Bind();
+    modelVB->SetLayout(BufferLayout({
+                                            {ShaderDataType::Float3, "position"}, {ShaderDataType::Float3, "normals"}, {ShaderDataType::Float2, "texCoords"}
+                                    }));
+    modelVA->AddVertexBuffer(modelVB);
+    modelVA->AddVertexBuffer(instanceVB);
+    modelVA->SetIndexBuffer(modelIB);
+    modelVA->Unbind();
+    return modelVA;
+}
 
+/**
+ * Box standing on the origin, in the units of the piece models
+ * @param width - width and depth of the box
+ * @param height - height of the box
+ * @return the box with a vertex per corner and face, so each face has its own normal
+ */
+Mesh PlaceholderMesh(float width, float height)
+{
+    Mesh box;
+    const auto& cube = GeometricTools::UnitCube3D24WNormals;
+    for (size_t i = 0; i < cube.size(); i += 6) {
+        MeshVertex vertex = {};
+        vertex.position[0] = cube[i] * width;
+        vertex.position[1] = (cube[i + 1] + 0.5f) * height;
+        vertex.position[2] = cube[i + 2] * width;
+        for (int axis = 0; axis < 3; axis++) {
+            vertex.normal[axis] = cube[i + 3 + axis];
         }
+        box.vertices.push_back(vertex);
     }
-
-    GLuint VAO;
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    GLuint VBO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-    //As you can see, OpenGL will accept a vector of structs as a valid input here
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), &vertices[0], GL_STATIC_DRAW);
-
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, nullptr);
-
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(sizeof(float) * 3));
-
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(sizeof(float) * 6));
-
-    //This will be needed later to specify how much we need to draw. Look at the main loop to find this variable again.
-    size = vertices.size();
-
-    return VAO;
-}
\ No newline at end of file
+    box.indices.assign(GeometricTools::cubeTopologyWNormals.begin(), GeometricTools::cubeTopologyWNormals.end());
+    return box;
+}
@@ -30,6 +30,7 @@ protected:
     static float diffStrength;
     static Shader* cubeShader;
     static Shader* gridShader;
+    static Shader* pieceShader;
     static ChessEngine* chessEngine;
 };
 
@@ -3,287 +3,229 @@
 //
 
 #include "ChessEngine.h"
-#include "fstream"
+#include "Attacks.h"
+#include "MoveGen.h"
+#include "Notation.h"
+#include "Zobrist.h"
 #include "set"
 #include "iostream"
-#include "algorithm"
 
-ChessEngine::ChessEngine() {
-    whiteTurn = true;
+ChessEngine::ChessEngine() : ChessEngine("logFile.txt") {}
+
+ChessEngine::ChessEngine(const std::string &logFile, bool verbose) : logFile(logFile), verbose(verbose) {
+    Attacks::init();
+
     whiteCheck = false;
-    whitePieces = std::vector<ChessPiece*>();
     whiteMoves = 0;
 
     blackCheck = false;
-    blackPieces = std::vector<ChessPiece*>();
     blackMoves = 0;
 
     selectedPiece = nullptr;
+    boardStale = true;
+    promotionType = QUEEN;
+    gameOver = false;
+    result = "*";
 
-    logFile = "logFile.txt";
+    if (!logFile.empty() && !moveLog.open(logFile)) {
+        std::cout << "Could not open file" << std::endl;
+    }
 
     resetBoard();
 }
 
-ChessEngine::~ChessEngine() {
-    for(auto piece : whitePieces){
-        delete piece;
-    }
-    for(auto piece : blackPieces){
-        delete piece;
+ChessEngine::~ChessEngine() = default;
+
+void ChessEngine::resetBoard() {
+    setFen(START_FEN);
+}
+
+int ChessEngine::resetBoard(const OpeningBook &book, int maxPlies, uint64_t seed) {
+    resetBoard();
+    int plies = 0;
+    while (plies < maxPlies) {
+        // One random number per move
+        Move m = book.pick(position, Zobrist::splitMix64(seed));
+        if (m == NO_MOVE || !playMove(m)) {
+            break;
+        }
+        plies++;
     }
+    return plies;
 }
 
-void ChessEngine::resetBoard() {
-    // Clear board
-    for(auto piece : whitePieces){
-        delete piece;
+/**
+ * Starts a new game from a position. An unfinished game in the log is closed with "*"
+ * @param fen - position in Forsyth-Edwards Notation
+ * @return false if fen is invalid, the board is then left as it was
+ */
+bool ChessEngine::setFen(const std::string &fen) {
+    Position loaded;
+    if (!loaded.setFromFen(fen)) {
+        return false;
     }
-    for(auto piece : blackPieces){
-        delete piece;
+    if (!gameOver && whiteMoves + blackMoves > 0) {
+        logResult("*");
     }
-    whitePieces.clear();
-    blackPieces.clear();
+    moveLog.flush();
 
+    position = loaded;
+    history.clear();
     whiteMoves = 0;
     blackMoves = 0;
-    whiteTurn = true;
-    whiteCheck = false;
-    blackCheck = false;
-    logFile = "logFile.txt";
-
-    // Initialize white pieces
-    whitePieces.push_back(new ChessPiece(0, ROOK, true));
-    whitePieces.push_back(new ChessPiece(1, KNIGHT, true));
-    whitePieces.push_back(new ChessPiece(2, BISHOP, true));
-    whitePieces.push_back(new ChessPiece(3, QUEEN, true));
-    whitePieces.push_back(new ChessPiece(4, KING, true));
-    whitePieces.push_back(new ChessPiece(5, BISHOP, true));
-    whitePieces.push_back(new ChessPiece(6, KNIGHT, true));
-    whitePieces.push_back(new ChessPiece(7, ROOK, true));
-    for(int i = 8; i < 16; i++){
-        whitePieces.push_back(new ChessPiece(i, PAWN, true));
-    }
-    // Initialize black pieces
-    blackPieces.push_back(new ChessPiece(56, ROOK, false));
-    blackPieces.push_back(new ChessPiece(57, KNIGHT, false));
-    blackPieces.push_back(new ChessPiece(58, BISHOP, false));
-    blackPieces.push_back(new ChessPiece(59, QUEEN, false));
-    blackPieces.push_back(new ChessPiece(60, KING, false));
-    blackPieces.push_back(new ChessPiece(61, BISHOP, false));
-    blackPieces.push_back(new ChessPiece(62, KNIGHT, false));
-    blackPieces.push_back(new ChessPiece(63, ROOK, false));
-    for(int i = 48; i < 56; i++){
-        blackPieces.push_back(new ChessPiece(i, PAWN, false));
+    gameOver = false;
+    result = "*";
+    selectedPiece = nullptr;
+    whiteCheck = position.sideToMove() == WHITE && position.inCheck();
+    blackCheck = position.sideToMove() == BLACK && position.inCheck();
+    // A position that is already mate or stalemate ends the game before a move, with nothing to log
+    MoveList moves;
+    generateLegalMoves(position, moves);
+    if (moves.size() == 0) {
+        gameOver = true;
+        result = !position.inCheck() ? "1/2-1/2" : (position.sideToMove() == WHITE ? "0-1" : "1-0");
     }
+    boardStale = true;
+    return true;
 }
 
-void ChessEngine::getLegalMoves(ChessPiece* piece, std::vector<int> &legalMoves){
-    auto type = piece->getType();
-    auto pos = piece->getPos();
-    auto white = piece->isWhite();
+std::string ChessEngine::getFen() const {
+    return position.toFen();
+}
 
-    if(whiteCheck && white){
-        std::cout << "White is in check" << std::endl;
-        return;
-    } else if(blackCheck && !white){
-        std::cout << "Black is in check" << std::endl;
-        return;
-    }
+int ChessEngine::getMoveCount() const {
+    return whiteMoves + blackMoves;
+}
 
-    switch (type) {
-        case PAWN:
-            // Pawn moves
-            if (white) {
-                if (pos / 8 == 1) {
-                    // Initial double move for white pawn
-                    legalMoves.push_back(pos + 16);
-                }
-                // Single move for white pawn
-                legalMoves.push_back(pos + 8);
-            } else {
-                if (pos / 8 == 6) {
-                    // Initial double move for black pawn
-                    legalMoves.push_back(pos - 16);
-                }
-                // Single move for black pawn
-                legalMoves.push_back(pos - 8);
-            }
-            break;
+// True once the game ended on the board, by mate, stalemate, repetition or the fifty-move rule
+bool ChessEngine::isGameOver() const {
+    return gameOver;
+}
 
-        case KNIGHT:
-            // Knight moves
-            if (pos % 8 > 1) {
-                if (pos / 8 > 0) {
-                    legalMoves.push_back(pos - 17);
-                }
-                if (pos / 8 < 7) {
-                    legalMoves.push_back(pos + 15);
-                }
-            }
-            if (pos % 8 > 0) {
-                if (pos / 8 > 1) {
-                    legalMoves.push_back(pos - 10);
-                }
-                if (pos / 8 < 6) {
-                    legalMoves.push_back(pos + 6);
-                }
-            }
-            if (pos % 8 < 6) {
-                if (pos / 8 > 0) {
-                    legalMoves.push_back(pos - 15);
-                }
-                if (pos / 8 < 7) {
-                    legalMoves.push_back(pos + 17);
-                }
-            }
-            if (pos % 8 < 7) {
-                if (pos / 8 > 1) {
-                    legalMoves.push_back(pos - 6);
-                }
-                if (pos / 8 < 6) {
-                    legalMoves.push_back(pos + 10);
-                }
-            }
-            break;
+const char* ChessEngine::getResult() const {
+    return result;
+}
 
-        case ROOK:
-            // Rook moves
-            for (int i = 0; i < 8; i++) {
-                if (i != pos % 8) {
-                    // Horizontal moves
-                    legalMoves.push_back(pos - (pos % 8) + i);
-                }
-                if (i != pos / 8) {
-                    // Vertical moves
-                    legalMoves.push_back(pos % 8 + i * 8);
-                }
-            }
-            break;
+/**
+ * Replays a game from a PGN database, starting from its FEN tag if it has one
+ * @return false if the game holds an illegal or unreadable move; the moves before it stay played
+ */
+bool ChessEngine::loadGame(const PgnGame &game) {
+    std::string_view fen = game.tag("FEN");
+    if (!setFen(fen.empty() ? std::string(START_FEN) : std::string(fen))) {
+        return false;
+    }
+    // Each ply's legal moves serve to parse its SAN, and playLegalMove leaves the next ply's in place
+    MoveList legal;
+    generateLegalMoves(position, legal);
+    PgnMoveTokens tokens(game.movetext);
+    std::string_view san;
+    while (tokens.next(san)) {
+        Move move = parseSan(position, san, legal);
+        if (move == NO_MOVE) {
+            return false;
+        }
+        playLegalMove(move, legal);
+    }
+    return true;
+}
 
-        case BISHOP:
-            // Bishop moves
-            for (int i = 0; i < 8; i++) {
-                if (pos % 8 + i < 8 && pos / 8 + i < 8) {
-                    legalMoves.push_back(pos + i * 9);
-                }
-                if (pos % 8 - i >= 0 && pos / 8 + i < 8) {
-                    legalMoves.push_back(pos + i * 7);
-                }
-                if (pos % 8 + i < 8 && pos / 8 - i >= 0) {
-                    legalMoves.push_back(pos - i * 7);
-                }
-                if (pos % 8 - i >= 0 && pos / 8 - i >= 0) {
-                    legalMoves.push_back(pos - i * 9);
-                }
-            }
-            break;
+/**
+ * Takes back the last move played
+ * @return false if there is no move to take back
+ */
+bool ChessEngine::undoMove() {
+    if (history.size() == 0) {
+        return false;
+    }
+    history.pop(position);
+    if (position.sideToMove() == WHITE) {
+        whiteMoves--;
+    } else {
+        blackMoves--;
+    }
+    selectedPiece = nullptr;
+    whiteCheck = position.sideToMove() == WHITE && position.inCheck();
+    blackCheck = position.sideToMove() == BLACK && position.inCheck();
+    boardStale = true;
+    return true;
+}
 
-        case QUEEN:
-            // Queen moves (combination of rook and bishop)
-            for (int i = 0; i < 8; i++) {
-                if (i != pos % 8) {
-                    // Horizontal moves
-                    legalMoves.push_back(pos - (pos % 8) + i);
-                }
-                if (i != pos / 8) {
-                    // Vertical moves
-                    legalMoves.push_back(pos % 8 + i * 8);
-                }
-            }
-            for (int i = 0; i < 8; i++) {
-                if (pos % 8 + i < 8 && pos / 8 + i < 8) {
-                    legalMoves.push_back(pos + i * 9);
-                }
-                if (pos % 8 - i >= 0 && pos / 8 + i < 8) {
-                    legalMoves.push_back(pos + i * 7);
-                }
-                if (pos % 8 + i < 8 && pos / 8 - i >= 0) {
-                    legalMoves.push_back(pos - i * 7);
-                }
-                if (pos % 8 - i >= 0 && pos / 8 - i >= 0) {
-                    legalMoves.push_back(pos - i * 9);
-                }
-            }
-            break;
+/**
+ * Rebuilds the ChessPiece view of the board from the position. Moves only mark the view stale,
+ * so engines nobody draws, like the ingest and self-play workers, never pay for it
+ */
+void ChessEngine::updateBoard() {
+    boardStale = false;
+    for (int sq = 0; sq < 64; sq++) {
+        int piece = position.pieceOn(sq);
+        if (piece != NO_PIECE) {
+            pieceView[sq] = ChessPiece(sq, typeOf(piece), colorOf(piece) == WHITE);
+        }
+    }
+}
 
-        case KING:
-            // King moves
-            if (pos % 8 > 0) {
-                legalMoves.push_back(pos - 1);
-                if (pos / 8 > 0) {
-                    legalMoves.push_back(pos - 9);
-                }
-                if (pos / 8 < 7) {
-                    legalMoves.push_back(pos + 7);
-                }
-            }
-            if (pos % 8 < 7) {
-                legalMoves.push_back(pos + 1);
-                if (pos / 8 > 0) {
-                    legalMoves.push_back(pos - 7);
-                }
-                if (pos / 8 < 7) {
-                    legalMoves.push_back(pos + 9);
-                }
-            }
-            if (pos / 8 > 0) {
-                legalMoves.push_back(pos - 8);
-            }
-            if (pos / 8 < 7) {
-                legalMoves.push_back(pos + 8);
-            }
-            break;
+/**
+ * Collects the legal moves of a single piece
+ * @param piece - piece to generate moves for, must belong to the side to move to get any moves
+ * @param legalMoves - list the moves are appended to
+ */
+void ChessEngine::getLegalMoves(ChessPiece* piece, MoveList &legalMoves){
+    MoveList allMoves;
+    generateLegalMoves(position, allMoves);
+    for (auto move : allMoves) {
+        if (moveFrom(move) == piece->getPos()) {
+            legalMoves.add(move);
+        }
     }
 }
 
-void ChessEngine::logMove(ChessPiece* piece, int pos){
-    std::fstream *file = new std::fstream(logFile, std::ios::out | std::ios::app);
-    if (!file->is_open()) {
-        std::cout << "Could not open file" << std::endl;
+/**
+ * Appends a move to the log in PGN movetext, opening a new game record on the first move
+ * and on a move after the result line, which starts from the current position.
+ * Call before the move is made
+ */
+void ChessEngine::logMove(Move move){
+    if (!moveLog.isOpen()) {
         return;
     }
-    std::string move = "";
-    char x = 'a' + (pos % 8);
-    int y = (pos / 8) + 1;
-
-
-    ChessPieceType type = piece->getType();
-    switch(type){
-        case PAWN:
-            move = x + std::to_string(y);
-            break;
-        case ROOK:
-            move = &"R" [ x] + std::to_string(y);
-            break;
-        case KNIGHT:
-            move = &"N" [ x] + std::to_string(y);
-            break;
-        case BISHOP:
-            move = &"B" [ x] + std::to_string(y);
-            break;
-        case QUEEN:
-            move = &"Q" [ x] + std::to_string(y);
-            break;
-        case KING:
-            move = &"K" [ x] + std::to_string(y);
-            break;
+    if (whiteMoves + blackMoves == 0 || gameOver) {
+        std::string header = "[Event \"ChessSim game\"]\n";
+        std::string fen = position.toFen();
+        if (fen != START_FEN) {
+            header += "[SetUp \"1\"]\n[FEN \"" + fen + "\"]\n";
+        }
+        moveLog.write(header);
     }
+    moveLog.write(std::to_string(position.fullmoves()) + (position.sideToMove() == WHITE ? ". " : "... ")
+                  + moveToSan(position, move));
+}
 
-    *file << (whiteTurn ? "White: " : "Black: ") << move << std::endl;
-
+// Ends the game record in the log with a PGN result and hands it to the OS
+void ChessEngine::logResult(const char* result) {
+    moveLog.write(std::string(result) + "\n");
+    moveLog.flush();
+    gameOver = true;
+    this->result = result;
 }
 
 std::vector<ChessPiece *> ChessEngine::getPieces() {
-    std::vector<ChessPiece*> pieces = std::vector<ChessPiece*>();
-    pieces.insert(pieces.end(), whitePieces.begin(), whitePieces.end());
-    pieces.insert(pieces.end(), blackPieces.begin(), blackPieces.end());
+    if (boardStale) {
+        updateBoard();
+    }
+    std::vector<ChessPiece*> pieces;
+    pieces.reserve(popCount(position.occupied()));
+    for (Bitboard b = position.pieces(WHITE); b; ) {
+        pieces.push_back(&pieceView[popLsb(b)]);
+    }
+    for (Bitboard b = position.pieces(BLACK); b; ) {
+        pieces.push_back(&pieceView[popLsb(b)]);
+    }
     return pieces;
 }
 
 void ChessEngine::setLogFile(std::string logFile) {
-    std::fstream *file = new std::fstream(logFile, std::ios::out | std::ios::app);
-    if (!file->is_open()) {
+    if (!moveLog.open(logFile)) {
         std::cout << "Could not open file" << std::endl;
         return;
     }
@@ -295,46 +237,31 @@ std::string ChessEngine::getLogFile() {
 }
 
 bool ChessEngine::checkMove(ChessPiece* piece, int pos){
-    //Check if white moves against white or black moves against black
-    for(auto p : whitePieces){
-        if(p->getPos() == pos){
-            if(p->isWhite() == piece->isWhite()){
-                return false;
-            }
-        }
-    }
-    for(auto p : blackPieces){
-        if(p->getPos() == pos){
-            if(p->isWhite() == piece->isWhite()){
-                return false;
-            }
+    MoveList legalMoves;
+    getLegalMoves(piece, legalMoves);
+    for (auto move : legalMoves) {
+        if (moveTo(move) == pos) {
+            return true;
         }
     }
-
-
-    return true;
+    return false;
 }
 
 void ChessEngine::tryMove(int pos) {
-    std::vector<int> legalMoves = std::vector<int>();
+    if (boardStale) {
+        updateBoard();
+    }
+    MoveList legalMoves;
     if(selectedPiece == nullptr){
-        for(auto piece : whitePieces){
-            if(piece->getPos() == pos){
-                selectedPiece = piece;
-                getLegalMoves(piece, legalMoves);
-                break;
-            }
-        }
-        for(auto piece : blackPieces){
-            if(piece->getPos() == pos){
-                selectedPiece = piece;
-                getLegalMoves(piece, legalMoves);
-                break;
-            }
+        if(position.isEmpty(pos)){
+            return;
         }
-        if(selectedPiece == nullptr){
+        if(colorOf(position.pieceOn(pos)) != position.sideToMove()){
+            printf("It is %s's turn\n", position.sideToMove() == WHITE ? "White" : "Black");
             return;
         }
+        selectedPiece = &pieceView[pos];
+        getLegalMoves(selectedPiece, legalMoves);
         char* type;
         switch(selectedPiece->getType()){
             case PAWN:
@@ -358,7 +285,7 @@ void ChessEngine::tryMove(int pos) {
         }
 
 
-        printf("Selected piece of type %s(%s) on %d\n", type, selectedPiece->isWhite() ? "White" : "Black", selectedPiece->getPos());
+        printf("Selected piece of type %s(%s) on %d with %d legal moves\n", type, selectedPiece->isWhite() ? "White" : "Black", selectedPiece->getPos(), legalMoves.size());
     } else {
         // Cancel move if same target pos is same as start pos
         if(selectedPiece->getPos() == pos){
@@ -372,23 +299,6 @@ void ChessEngine::tryMove(int pos) {
 }
 
 void ChessEngine::movePiece(ChessPiece *piece, int pos) {
-    if(piece->isWhite()){
-        whiteMoves++;
-        for(auto p : blackPieces){
-            if(p->getPos() == pos){
-                blackPieces.erase(std::remove(blackPieces.begin(), blackPieces.end(), p), blackPieces.end());
-                break;
-            }
-        }
-    } else {
-        blackMoves++;
-        for(auto p : whitePieces){
-            if(p->getPos() == pos){
-                whitePieces.erase(std::remove(whitePieces.begin(), whitePieces.end(), p), whitePieces.end());
-                break;
-            }
-        }
-    }
     char* type;
     switch(piece->getType()){
         case PAWN:
@@ -413,17 +323,110 @@ void ChessEngine::movePiece(ChessPiece *piece, int pos) {
 
 
     printf("Moving piece of type %s(%s)from %d to %d\n", type, piece->isWhite() ? "White" : "Black", piece->getPos(), pos);
-    piece->setPos(pos);
+
+    // Pick the legal move matching the squares. Promotions use the chosen promotion piece
+    MoveList legalMoves;
+    getLegalMoves(piece, legalMoves);
+    for (auto m : legalMoves) {
+        if (moveTo(m) == pos && (!isPromotion(m) || ::promotionType(m) == promotionType)) {
+            playMove(m);
+            return;
+        }
+    }
+}
+
+/**
+ * Plays a move for the side to move, logs it and reports the state of the game
+ * @return false if move is not legal in the current position
+ */
+bool ChessEngine::playMove(Move move) {
+    MoveList legalMoves;
+    generateLegalMoves(position, legalMoves);
+    if (!legalMoves.contains(move)) {
+        return false;
+    }
+    playLegalMove(move, legalMoves);
+    return true;
+}
+
+void ChessEngine::playLegalMove(Move move, MoveList &legal) {
+    // Playing on after the game ended, after undoMove or past a repetition nobody claimed, continues in a new record
+    logMove(move);
+    gameOver = false;
+    result = "*";
+    if (position.sideToMove() == WHITE) {
+        whiteMoves++;
+    } else {
+        blackMoves++;
+    }
+    // The history only limits how far back undoMove can go, so start over rather than fail when it is full
+    if (history.full()) {
+        history.clear();
+    }
+    history.push(position, move);
 
     selectedPiece = nullptr;
-    whiteTurn = !whiteTurn;
+    boardStale = true;
+
+    // Update check flags for the side that is now to move
+    bool inCheck = position.inCheck();
+    whiteCheck = position.sideToMove() == WHITE && inCheck;
+    blackCheck = position.sideToMove() == BLACK && inCheck;
+
+    legal.clear();
+    generateLegalMoves(position, legal);
+    const char* message = nullptr;
+    if (legal.size() == 0) {
+        if (inCheck) {
+            message = position.sideToMove() == WHITE ? "Checkmate, Black wins" : "Checkmate, White wins";
+            logResult(position.sideToMove() == WHITE ? "0-1" : "1-0");
+        } else {
+            message = "Stalemate";
+            logResult("1/2-1/2");
+        }
+    } else if (history.repetitions(position) >= 2) {
+        message = "Draw by threefold repetition";
+        logResult("1/2-1/2");
+    } else if (position.halfmoves() >= 100) {
+        message = "Draw by the fifty-move rule";
+        logResult("1/2-1/2");
+    } else if (inCheck) {
+        message = whiteCheck ? "White is in check" : "Black is in check";
+    }
+    if (message && verbose) {
+        printf("%s\n", message);
+    }
+}
 
-    if(piece->getType() == PAWN && (pos / 8 == 0 || pos / 8 == 7)){
-        // Promote pawn TODO: MORE OPTIONS FOR PROMOTION
-        piece->setType(QUEEN);
+bool ChessEngine::playSan(std::string_view san) {
+    MoveList legal;
+    generateLegalMoves(position, legal);
+    Move move = parseSan(position, san, legal);
+    if (move == NO_MOVE) {
+        return false;
     }
+    playLegalMove(move, legal);
+    return true;
 }
 
 ChessPiece *const &ChessEngine::getSelectedPiece() const {
     return selectedPiece;
 }
+
+const Position &ChessEngine::getPosition() const {
+    return position;
+}
+
+const MoveHistory &ChessEngine::getHistory() const {
+    return history;
+}
+
+void ChessEngine::setPromotionType(ChessPieceType type) {
+    if (type != PAWN && type != KING) {
+        promotionType = type;
+    }
+}
+
+ChessPieceType ChessEngine::getPromotionType() const {
+    return promotionType;
+}
@@ -7,32 +7,74 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include "Book.h"
 #include "ChessPiece.h"
+#include "LogWriter.h"
+#include "Pgn.h"
+#include "Position.h"
+#include "Move.h"
 
 class ChessEngine {
 private:
-    std::vector <ChessPiece*> whitePieces;
+    Position position;
+    MoveHistory history;        // Moves played since resetBoard(), used by undoMove()
+    ChessPiece pieceView[64];   // One view object per square, refreshed by updateBoard()
+    bool boardStale;            // The position changed since updateBoard(); the view is refreshed when next used
     int whiteMoves;
     int blackMoves;
-    bool whiteTurn;
     bool whiteCheck;
     bool blackCheck;
     std::string logFile;
+    LogWriter moveLog;          // Stays open on logFile, written to once per move as PGN
+    bool gameOver;              // The game has ended; its result is in the log unless it ended before any move
+    const char* result;         // PGN result of the game, "*" while it is running
+    bool verbose;               // Print game state messages to stdout
     ChessPiece* selectedPiece;
-    std::vector <ChessPiece*> blackPieces;
+    ChessPieceType promotionType;   // Piece a pawn reaching the last rank becomes
 public:
     ChessEngine();
+    // An empty logFile plays without a move log, for headless batch use
+    explicit ChessEngine(const std::string &logFile, bool verbose = true);
     ~ChessEngine();
     void setLogFile(std::string logFile);
     std::string getLogFile();
-    void logMove(ChessPiece* piece, int pos);
+    void logMove(Move move);
+    void logResult(const char* result);
     void movePiece(ChessPiece* piece, int pos);
+    bool playMove(Move move);
+    /**
+     * Plays a move already matched against legal, the legal moves of the current position, without
+     * generating them again, and refills legal with the legal moves after it. For batch replays
+     * such as loadGame, where each ply would otherwise generate the legal moves three times
+     */
+    void playLegalMove(Move move, MoveList &legal);
+    bool playSan(std::string_view san);
+    bool setFen(const std::string &fen);
+    std::string getFen() const;
+    // Plies played since the game started
+    int getMoveCount() const;
+    bool isGameOver() const;
+    const char* getResult() const;
+    bool loadGame(const PgnGame &game);
     void updateBoard();
     void tryMove(int pos);
     std::vector<ChessPiece*> getPieces();
-    void getLegalMoves(ChessPiece* piece, std::vector<int> &legalMoves);
+    void getLegalMoves(ChessPiece* piece, MoveList &legalMoves);
     bool checkMove(ChessPiece* piece, int pos);
     void resetBoard();
+    /**
+     * Starts a new game and plays book moves from the start position, picked by weight.
+     * @param maxPlies - stop after this many moves even if the book goes on
+     * @param seed     - the same seed plays the same line
+     * @return the number of book moves played
+     */
+    int resetBoard(const OpeningBook &book, int maxPlies, uint64_t seed);
+    bool undoMove();
+    const Position &getPosition() const;
+    const MoveHistory &getHistory() const;
+    void setPromotionType(ChessPieceType type);
+    ChessPieceType getPromotionType() const;
 
     ChessPiece *const &getSelectedPiece() const;
 };
@@ -8,6 +8,8 @@ bool ChessPiece::isWhite() const {
     return white;
 }
 
+ChessPiece::ChessPiece() : pos(0), type(PAWN), white(true) {}
+
 ChessPiece::ChessPiece(int pos, int type, bool white) {
     this->pos = pos;
     this->type = (ChessPieceType) type;
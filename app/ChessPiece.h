@@ -22,6 +22,7 @@ private:
     ChessPieceType type;
     bool white;
 public:
+    ChessPiece();
     ChessPiece(int pos, int type, bool white);
     ~ChessPiece();
     int getPos() const;
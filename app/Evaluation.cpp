@@ -0,0 +1,236 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Evaluation.h"
+#include "Attacks.h"
+#include <algorithm>
+
+namespace {
+    // Passed pawn bonus by rank as seen from the pawn's own side
+    constexpr int PASSED_MG[8] = {0, 5, 10, 15, 30, 50, 80, 0};
+    constexpr int PASSED_EG[8] = {0, 10, 15, 25, 45, 75, 120, 0};
+    constexpr int DOUBLED_MG = 10, DOUBLED_EG = 20;
+    constexpr int ISOLATED_MG = 10, ISOLATED_EG = 15;
+
+    // Per safe square beyond the usual count, indexed by ChessPieceType
+    constexpr int MOBILITY_MG[6] = {0, 3, 4, 5, 1, 0};
+    constexpr int MOBILITY_EG[6] = {0, 5, 4, 5, 2, 0};
+    constexpr int MOBILITY_BASE[6] = {0, 7, 4, 6, 13, 0};
+
+    // Per attacked square around the enemy king, indexed by ChessPieceType
+    constexpr int KING_ATTACK_WEIGHTS[6] = {0, 3, 2, 2, 5, 0};
+    constexpr int KING_ATTACK_MAX = 500;
+    constexpr int SHIELD_PAWN_MISSING = 15;
+
+    constexpr int BISHOP_PAIR_MG = 30, BISHOP_PAIR_EG = 50;
+    constexpr int TEMPO = 10;
+
+    Bitboard fileBB(int file) {
+        return FILE_A_BB << file;
+    }
+
+    Bitboard adjacentFilesBB(int file) {
+        return (file > 0 ? fileBB(file - 1) : 0) | (file < 7 ? fileBB(file + 1) : 0);
+    }
+
+    // All squares on the ranks in front of sq, seen from color's side
+    Bitboard forwardRanksBB(Color color, int sq) {
+        int rank = rankOf(sq);
+        if (color == WHITE) {
+            return rank == 7 ? 0 : ~0ULL << (8 * (rank + 1));
+        }
+        return (1ULL << (8 * rank)) - 1;
+    }
+
+    Bitboard pawnAttacksBB(Color color, Bitboard pawns) {
+        if (color == WHITE) {
+            return ((pawns & ~FILE_A_BB) << 7) | ((pawns & ~FILE_H_BB) << 9);
+        }
+        return ((pawns & ~FILE_A_BB) >> 9) | ((pawns & ~FILE_H_BB) >> 7);
+    }
+
+    void evaluatePawns(const Position &pos, PawnEntry &entry) {
+        entry.key = pos.pawnKey();
+        entry.mg = 0;
+        entry.eg = 0;
+        entry.passed = 0;
+        for (Color us : {WHITE, BLACK}) {
+            int sign = us == WHITE ? 1 : -1;
+            Bitboard ours = pos.pieces(us, PAWN);
+            Bitboard theirs = pos.pieces(~us, PAWN);
+            for (Bitboard b = ours; b; ) {
+                int sq = popLsb(b);
+                int file = fileOf(sq);
+                Bitboard front = forwardRanksBB(us, sq);
+                // A doubled pawn is counted once, on the rear pawn
+                if (ours & fileBB(file) & front) {
+                    entry.mg -= sign * DOUBLED_MG;
+                    entry.eg -= sign * DOUBLED_EG;
+                }
+                if (!(ours & adjacentFilesBB(file))) {
+                    entry.mg -= sign * ISOLATED_MG;
+                    entry.eg -= sign * ISOLATED_EG;
+                }
+                if (!(theirs & (fileBB(file) | adjacentFilesBB(file)) & front)) {
+                    int rank = us == WHITE ? rankOf(sq) : 7 - rankOf(sq);
+                    entry.mg += sign * PASSED_MG[rank];
+                    entry.eg += sign * PASSED_EG[rank];
+                    entry.passed |= squareBB(sq);
+                }
+            }
+        }
+    }
+}
+
+PawnTable::PawnTable(size_t entryCount) : entries(entryCount) {
+    clear();
+}
+
+const PawnEntry &PawnTable::probe(const Position &pos) {
+    PawnEntry &entry = entries[pos.pawnKey() & (entries.size() - 1)];
+    if (entry.key != pos.pawnKey()) {
+        evaluatePawns(pos, entry);
+    }
+    return entry;
+}
+
+// Zeroed entries are valid: key 0 is the pawnless key, and without pawns every term is 0
+void PawnTable::clear() {
+    for (auto &entry : entries) {
+        entry = {0, 0, 0, 0};
+    }
+}
+
+int evaluate(const Position &pos, PawnTable* pawns) {
+    PawnEntry local;
+    if (!pawns) {
+        evaluatePawns(pos, local);
+    }
+    const PawnEntry &pawnEntry = pawns ? pawns->probe(pos) : local;
+    int mg = pos.mgScore() + pawnEntry.mg;
+    int eg = pos.egScore() + pawnEntry.eg;
+
+    Bitboard occupied = pos.occupied();
+    for (Color us : {WHITE, BLACK}) {
+        Color them = ~us;
+        int sign = us == WHITE ? 1 : -1;
+
+        // Mobility counts squares not blocked by our own pieces nor covered by enemy pawns
+        Bitboard safe = ~pos.pieces(us) & ~pawnAttacksBB(them, pos.pieces(them, PAWN));
+        int theirKing = pos.kingSquare(them);
+        Bitboard kingZone = Attacks::king(theirKing) | squareBB(theirKing);
+        int kingAttackers = 0;
+        int kingAttackWeight = 0;
+        for (ChessPieceType type : {KNIGHT, BISHOP, ROOK, QUEEN}) {
+            for (Bitboard b = pos.pieces(us, type); b; ) {
+                Bitboard attacks = Attacks::piece(type, popLsb(b), occupied);
+                int squares = popCount(attacks & safe) - MOBILITY_BASE[type];
+                mg += sign * MOBILITY_MG[type] * squares;
+                eg += sign * MOBILITY_EG[type] * squares;
+                if (attacks & kingZone) {
+                    kingAttackers++;
+                    kingAttackWeight += KING_ATTACK_WEIGHTS[type] * popCount(attacks & kingZone);
+                }
+            }
+        }
+        // A single attacker is rarely dangerous, several grow quickly more so
+        if (kingAttackers >= 2) {
+            mg += sign * std::min(kingAttackWeight * kingAttackWeight / 2, KING_ATTACK_MAX);
+        }
+
+        // Pawn shield in front of a castled or uncastled king on its first two ranks
+        int ourKing = pos.kingSquare(us);
+        int kingRank = rankOf(ourKing);
+        if ((us == WHITE && kingRank <= 1) || (us == BLACK && kingRank >= 6)) {
+            int step = us == WHITE ? 1 : -1;
+            Bitboard shieldRanks = (RANK_1_BB << (8 * (kingRank + step))) | (RANK_1_BB << (8 * (kingRank + 2 * step)));
+            Bitboard ourPawns = pos.pieces(us, PAWN);
+            for (int file = std::max(0, fileOf(ourKing) - 1); file <= std::min(7, fileOf(ourKing) + 1); file++) {
+                if (!(ourPawns & fileBB(file) & shieldRanks)) {
+                    mg -= sign * SHIELD_PAWN_MISSING;
+                }
+            }
+        }
+
+        if (popCount(pos.pieces(us, BISHOP)) >= 2) {
+            mg += sign * BISHOP_PAIR_MG;
+            eg += sign * BISHOP_PAIR_EG;
+        }
+    }
+
+    int phase = pos.gamePhase();
+    int score = (mg * phase + eg * (Psqt::PHASE_MAX - phase)) / Psqt::PHASE_MAX;
+    return (pos.sideToMove() == WHITE ? score : -score) + TEMPO;
+}
+
+bool seeGE(const Position &pos, Move m, int threshold) {
+    if (isCastle(m) || isPromotion(m)) {
+        return 0 >= threshold;
+    }
+    int from = moveFrom(m);
+    int to = moveTo(m);
+    Bitboard occupied = pos.occupied() ^ squareBB(from);
+    int captured = 0;
+    if (moveFlags(m) == EP_CAPTURE) {
+        captured = PIECE_VALUES[PAWN];
+        occupied ^= squareBB(to + (pos.sideToMove() == WHITE ? -8 : 8));
+    } else if (isCapture(m)) {
+        captured = PIECE_VALUES[typeOf(pos.pieceOn(to))];
+    }
+
+    // swap is what the side that just captured stands to gain if the other side stops here,
+    // negated every time the turn passes
+    int swap = captured - threshold;
+    if (swap < 0) {
+        return false;
+    }
+    swap = PIECE_VALUES[typeOf(pos.pieceOn(from))] - swap;
+    if (swap <= 0) {
+        return true;
+    }
+
+    Bitboard bishopsQueens = pos.pieces(WHITE, BISHOP) | pos.pieces(BLACK, BISHOP)
+                           | pos.pieces(WHITE, QUEEN) | pos.pieces(BLACK, QUEEN);
+    Bitboard rooksQueens = pos.pieces(WHITE, ROOK) | pos.pieces(BLACK, ROOK)
+                         | pos.pieces(WHITE, QUEEN) | pos.pieces(BLACK, QUEEN);
+    Bitboard attackers = pos.attackersTo(to, occupied);
+    Color side = pos.sideToMove();
+    bool result = true;
+    for (;;) {
+        side = ~side;
+        attackers &= occupied;
+        Bitboard ours = attackers & pos.pieces(side);
+        if (!ours) {
+            break;
+        }
+        result = !result;
+
+        // Capture with the least valuable attacker, then let the sliders behind it through
+        ChessPieceType type = PAWN;
+        Bitboard candidates = 0;
+        for (ChessPieceType t : {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING}) {
+            candidates = ours & pos.pieces(side, t);
+            if (candidates) {
+                type = t;
+                break;
+            }
+        }
+        if (type == KING) {
+            // The king may only take last: if the other side still attacks, the capture is illegal
+            return (attackers & pos.pieces(~side)) ? !result : result;
+        }
+        swap = PIECE_VALUES[type] - swap;
+        if (swap < (int) result) {
+            break;
+        }
+        occupied ^= squareBB(lsb(candidates));
+        if (type == PAWN || type == BISHOP || type == QUEEN) {
+            attackers |= Attacks::bishop(to, occupied) & bishopsQueens;
+        }
+        if (type == ROOK || type == QUEEN) {
+            attackers |= Attacks::rook(to, occupied) & rooksQueens;
+        }
+    }
+    return result;
+}
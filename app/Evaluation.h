@@ -0,0 +1,60 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_EVALUATION_H
+#define EXAMAUTUMN2023_EVALUATION_H
+
+#include <cstdint>
+#include <vector>
+#include "Move.h"
+#include "Position.h"
+
+// Piece values in centipawns, indexed by ChessPieceType. Used where one number per piece
+// is enough, like exchange evaluation; the evaluation itself uses Psqt
+constexpr int PIECE_VALUES[6] = {100, 500, 320, 330, 900, 0};
+
+// Pawn structure terms of one pawn setup, from white's point of view
+struct PawnEntry {
+    uint64_t key;
+    int mg;
+    int eg;
+    Bitboard passed;        // Passed pawns of both colors
+};
+
+/**
+ * Cache of pawn structure evaluations indexed by Position::pawnKey(). Pawns
+ * move rarely, so nearly every lookup in a search is a hit. One table per
+ * search thread, nothing in it is shared.
+ */
+class PawnTable {
+private:
+    std::vector<PawnEntry> entries;
+
+public:
+    // entryCount must be a power of two
+    explicit PawnTable(size_t entryCount = 1 << 14);
+    const PawnEntry &probe(const Position &pos);
+    void clear();
+};
+
+/**
+ * Static score of pos in centipawns, from the point of view of the side to move.
+ * Material and piece-square terms come from the position's incremental sums,
+ * pawn structure from pawns (computed on the spot without one), mobility and
+ * king safety from the attack tables. Middlegame and endgame scores are
+ * blended by the game phase.
+ */
+int evaluate(const Position &pos, PawnTable* pawns = nullptr);
+
+/**
+ * Static exchange evaluation: whether the capture sequence started by m on its
+ * target square, each side recapturing with its least valuable attacker and
+ * free to stop, gains at least threshold centipawns for the side to move.
+ * Works on attack sets only, no move is made. X-ray attackers behind the
+ * pieces that capture join in; pins are ignored. Castling and promotions
+ * count as an even exchange.
+ */
+bool seeGE(const Position &pos, Move m, int threshold = 0);
+
+#endif //EXAMAUTUMN2023_EVALUATION_H
@@ -0,0 +1,120 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "LogWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+LogWriter::LogWriter() : ring(new char[CAPACITY]) {}
+
+LogWriter::~LogWriter() {
+    close();
+}
+
+bool LogWriter::open(const std::string &path) {
+    FILE* newFile = fopen(path.c_str(), "a");
+    if (!newFile) {
+        return false;
+    }
+    close();
+    file = newFile;
+    stopping = false;
+    writer = std::thread(&LogWriter::writerLoop, this);
+    return true;
+}
+
+void LogWriter::close() {
+    if (!file) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    fclose(file);
+    file = nullptr;
+}
+
+void LogWriter::write(const char* line, size_t length) {
+    if (!file) {
+        return;
+    }
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t remaining = length + 1;
+    while (remaining > 0) {
+        size_t space = CAPACITY - (h - tail.load(std::memory_order_acquire));
+        if (space == 0) {
+            wake.notify_one();
+            std::this_thread::yield();
+            continue;
+        }
+        // Copy up to the end of the ring or the free space, whichever comes first
+        size_t offset = h & (CAPACITY - 1);
+        size_t chunk = std::min({remaining, space, CAPACITY - offset});
+        size_t written = length + 1 - remaining;
+        if (written + chunk > length) {
+            memcpy(&ring[offset], line + written, chunk - 1);
+            ring[offset + chunk - 1] = '\n';
+        } else {
+            memcpy(&ring[offset], line + written, chunk);
+        }
+        h += chunk;
+        remaining -= chunk;
+        head.store(h, std::memory_order_release);
+    }
+    if (h - tail.load(std::memory_order_relaxed) >= CAPACITY / 2) {
+        wake.notify_one();
+    }
+}
+
+void LogWriter::flush() {
+    if (!file) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t request = ++flushRequested;
+    wake.notify_one();
+    flushed.wait(lock, [this, request] { return flushCompleted >= request; });
+}
+
+void LogWriter::drain() {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t h = head.load(std::memory_order_acquire);
+    while (t != h) {
+        size_t offset = t & (CAPACITY - 1);
+        size_t chunk = std::min(h - t, CAPACITY - offset);
+        fwrite(&ring[offset], 1, chunk, file);
+        t += chunk;
+    }
+    tail.store(t, std::memory_order_release);
+}
+
+void LogWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        // Wake up now and then to batch whatever arrived, early for a flush, a close or a filling buffer
+        wake.wait_for(lock, std::chrono::milliseconds(100), [this] {
+            return stopping || flushRequested != flushCompleted
+                   || head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed) >= CAPACITY / 2;
+        });
+        bool stop = stopping;
+        uint64_t request = flushRequested;
+        lock.unlock();
+
+        drain();
+        if (stop || request != flushCompleted) {
+            fflush(file);
+        }
+
+        lock.lock();
+        flushCompleted = request;
+        flushed.notify_all();
+        if (stop) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_LOGWRITER_H
+#define EXAMAUTUMN2023_LOGWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Append-only text log that stays open. The owning thread copies lines into
+ * a lock-free single-producer/single-consumer ring buffer, a background
+ * thread drains it in batches, and the file is only flushed to the OS when
+ * flush() or close() asks for it.
+ *
+ * write() must always be called from the same thread.
+ */
+class LogWriter {
+private:
+    static constexpr size_t CAPACITY = 1 << 16;  // Power of two, so positions wrap with a mask
+
+    std::unique_ptr<char[]> ring;
+    // Running byte counts, head written by the producer and tail by the writer thread.
+    // Kept on separate cache lines so the two threads do not fight over one
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+
+    FILE* file = nullptr;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable flushed;
+    bool stopping = false;
+    uint64_t flushRequested = 0;
+    uint64_t flushCompleted = 0;
+
+    void writerLoop();
+    void drain();
+
+public:
+    LogWriter();
+    ~LogWriter();
+
+    LogWriter(const LogWriter&) = delete;
+    LogWriter &operator=(const LogWriter&) = delete;
+
+    /**
+     * Switches to appending to path. Whatever was written before goes to the old file first
+     * @return false if path cannot be opened, the old file then stays in use
+     */
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // Queues line plus a newline. Only blocks if the writer thread is a whole buffer behind
+    void write(const char* line, size_t length);
+    void write(const std::string &line) { write(line.data(), line.size()); }
+
+    // Returns once everything written so far has been handed to the OS
+    void flush();
+};
+
+#endif //EXAMAUTUMN2023_LOGWRITER_H
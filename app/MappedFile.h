@@ -0,0 +1,49 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_MAPPEDFILE_H
+#define EXAMAUTUMN2023_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * Read-only memory mapping of a whole file. Pages are read in by the OS on
+ * first touch and can be dropped again under memory pressure, so files far
+ * larger than RAM can be walked through as one contiguous string_view.
+ */
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;        // An empty file is open but has nothing mapped
+#if defined(_WIN32)
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+public:
+    enum AccessPattern {
+        SEQUENTIAL,     // Read front to back once: aggressive read-ahead
+        RANDOM          // Scattered lookups: no read-ahead
+    };
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+
+    // Maps path, closing whatever was mapped before. Returns false if it cannot be opened
+    bool open(const std::string &path, AccessPattern pattern = SEQUENTIAL);
+    void close();
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    std::string_view view() const { return {bytes, length}; }
+};
+
+#endif //EXAMAUTUMN2023_MAPPEDFILE_H
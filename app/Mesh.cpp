@@ -0,0 +1,345 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Mesh.h"
+#include "tiny_obj_loader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+    const char MESH_MAGIC[4] = {'C', 'M', 'S', 'H'};
+
+    struct MeshHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceHash;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t vertexSize;        // sizeof(MeshVertex) of the program that wrote the file
+        uint32_t reserved;
+    };
+    static_assert(sizeof(MeshHeader) == 32, "the vertices start at byte 32");
+
+    // Hashes and compares vertices bit for bit, -0.0 is turned into 0.0 before a vertex gets here
+    struct VertexHash {
+        size_t operator()(const MeshVertex &vertex) const {
+            uint32_t words[8];
+            memcpy(words, &vertex, sizeof(words));
+            uint64_t hash = 14695981039346656037ull;
+            for (uint32_t word : words) {
+                hash = (hash ^ word) * 1099511628211ull;
+            }
+            return (size_t) hash;
+        }
+    };
+
+    struct VertexEqual {
+        bool operator()(const MeshVertex &a, const MeshVertex &b) const {
+            return memcmp(&a, &b, sizeof(MeshVertex)) == 0;
+        }
+    };
+
+    // Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" scoring
+    constexpr int CACHE_SIZE = 32;
+    constexpr float CACHE_DECAY_POWER = 1.5f;
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+    /**
+     * How much drawing one more triangle of a vertex is worth: a lot while the
+     * vertex is near the front of the cache, and more for vertices with few
+     * triangles left, so that none are left behind to be transformed again later.
+     */
+    float vertexScore(int cachePosition, int remainingTriangles) {
+        if (remainingTriangles == 0) {
+            return -1.0f;
+        }
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            if (cachePosition < 3) {
+                // Just used by the last triangle: a good next triangle shares an edge, not just a vertex
+                score = LAST_TRIANGLE_SCORE;
+            } else {
+                float scale = 1.0f / (CACHE_SIZE - 3);
+                score = std::pow(1.0f - (float) (cachePosition - 3) * scale, CACHE_DECAY_POWER);
+            }
+        }
+        return score + VALENCE_BOOST_SCALE * std::pow((float) remainingTriangles, -VALENCE_BOOST_POWER);
+    }
+}
+
+bool loadObjMesh(const std::string &path, Mesh &mesh) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn;
+    std::string err;
+    std::string directory = std::filesystem::path(path).parent_path().string() + "/";
+    bool ok = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), directory.c_str());
+    if (!warn.empty()) {
+        std::cout << warn << std::endl;
+    }
+    if (!err.empty()) {
+        std::cerr << err << std::endl;
+    }
+    if (!ok) {
+        return false;
+    }
+
+    size_t corners = 0;
+    for (const auto &shape : shapes) {
+        corners += shape.mesh.indices.size();
+    }
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    mesh.indices.reserve(corners);
+    // Most corners of a closed model share their vertex with several others
+    mesh.vertices.reserve(corners / 4);
+    std::unordered_map<MeshVertex, uint32_t, VertexHash, VertexEqual> welded;
+    welded.reserve(corners / 4);
+
+    // Corners weld by value, not by OBJ index: exporters often repeat positions and normals
+    for (const auto &shape : shapes) {
+        for (const auto &corner : shape.mesh.indices) {
+            MeshVertex vertex = {};
+            for (int i = 0; i < 3; i++) {
+                vertex.position[i] = attrib.vertices[3 * corner.vertex_index + i] + 0.0f;
+                if (corner.normal_index >= 0) {
+                    vertex.normal[i] = attrib.normals[3 * corner.normal_index + i] + 0.0f;
+                }
+            }
+            if (corner.texcoord_index >= 0) {
+                vertex.texCoords[0] = attrib.texcoords[2 * corner.texcoord_index] + 0.0f;
+                vertex.texCoords[1] = attrib.texcoords[2 * corner.texcoord_index + 1] + 0.0f;
+            }
+            auto inserted = welded.emplace(vertex, (uint32_t) mesh.vertices.size());
+            if (inserted.second) {
+                mesh.vertices.push_back(vertex);
+            }
+            mesh.indices.push_back(inserted.first->second);
+        }
+    }
+    return !mesh.indices.empty();
+}
+
+void optimizeVertexCache(Mesh &mesh) {
+    size_t triangleCount = mesh.indices.size() / 3;
+    size_t vertexCount = mesh.vertices.size();
+    if (triangleCount == 0) {
+        return;
+    }
+    // Triangles of every vertex, as one array with an offset per vertex
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (uint32_t index : mesh.indices) {
+        offsets[index + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<uint32_t> adjacency(mesh.indices.size());
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t v = mesh.indices[3 * t + corner];
+            adjacency[offsets[v] + remaining[v]++] = (uint32_t) t;
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        score[v] = vertexScore(-1, (int) remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScore[t] = score[mesh.indices[3 * t]] + score[mesh.indices[3 * t + 1]] + score[mesh.indices[3 * t + 2]];
+    }
+
+    std::vector<uint32_t> ordered;
+    ordered.reserve(mesh.indices.size());
+    // Most recently used first; the triangle just drawn pushes up to three vertices past the end
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> nextCache;
+    cache.reserve(CACHE_SIZE + 3);
+    nextCache.reserve(CACHE_SIZE + 3);
+    size_t cursor = 0;      // Triangles before it have all been emitted
+    long best = -1;
+    while (ordered.size() < mesh.indices.size()) {
+        if (best < 0) {
+            // Nothing left around the cache: continue with the next triangle not drawn yet
+            while (emitted[cursor]) {
+                cursor++;
+            }
+            best = (long) cursor;
+        }
+        const uint32_t* triangle = &mesh.indices[3 * best];
+        emitted[best] = true;
+        nextCache.clear();
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t v = triangle[corner];
+            ordered.push_back(v);
+            nextCache.push_back(v);
+            // Take the triangle out of the vertex's list of triangles still to draw
+            uint32_t* first = &adjacency[offsets[v]];
+            uint32_t* last = first + remaining[v];
+            *std::find(first, last, (uint32_t) best) = *(last - 1);
+            remaining[v]--;
+        }
+        for (uint32_t v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                nextCache.push_back(v);
+            }
+        }
+        cache.swap(nextCache);
+
+        // Rescore the vertices that moved in the cache and the triangles around them
+        for (size_t i = 0; i < cache.size(); i++) {
+            uint32_t v = cache[i];
+            cachePosition[v] = i < (size_t) CACHE_SIZE ? (int) i : -1;
+            float updated = vertexScore(cachePosition[v], (int) remaining[v]);
+            float delta = updated - score[v];
+            score[v] = updated;
+            for (uint32_t k = 0; k < remaining[v]; k++) {
+                triangleScore[adjacency[offsets[v] + k]] += delta;
+            }
+        }
+        if (cache.size() > (size_t) CACHE_SIZE) {
+            cache.resize(CACHE_SIZE);
+        }
+        // The best next triangle is one that uses a cached vertex
+        best = -1;
+        float bestScore = -1.0f;
+        for (uint32_t v : cache) {
+            for (uint32_t k = 0; k < remaining[v]; k++) {
+                uint32_t t = adjacency[offsets[v] + k];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = (long) t;
+                }
+            }
+        }
+    }
+    mesh.indices.swap(ordered);
+}
+
+void optimizeVertexFetch(Mesh &mesh) {
+    std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+    std::vector<MeshVertex> ordered;
+    ordered.reserve(mesh.vertices.size());
+    for (uint32_t &index : mesh.indices) {
+        if (remap[index] == UINT32_MAX) {
+            remap[index] = (uint32_t) ordered.size();
+            ordered.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    // Vertices no triangle uses are dropped
+    mesh.vertices.swap(ordered);
+}
+
+uint64_t hashFile(const std::string &path) {
+    MappedFile source;
+    if (!source.open(path, MappedFile::SEQUENTIAL)) {
+        return 0;
+    }
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < source.size(); i++) {
+        hash = (hash ^ (unsigned char) source.data()[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool MeshFile::open(const std::string &path, uint64_t sourceHash) {
+    close();
+    if (!file.open(path, MappedFile::SEQUENTIAL) || file.size() < sizeof(MeshHeader)) {
+        file.close();
+        return false;
+    }
+    MeshHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    uint64_t expectedSize = sizeof(MeshHeader) + (uint64_t) header.vertexCount * sizeof(MeshVertex)
+                            + (uint64_t) header.indexCount * sizeof(uint32_t);
+    if (memcmp(header.magic, MESH_MAGIC, 4) != 0 || header.version != VERSION || header.sourceHash != sourceHash
+        || header.vertexSize != sizeof(MeshVertex) || header.indexCount == 0 || file.size() != expectedSize) {
+        file.close();
+        return false;
+    }
+    // The mapping is page aligned and the header keeps both arrays at 4 byte alignment
+    vertexData = (const MeshVertex*) (file.data() + sizeof(MeshHeader));
+    indexData = (const uint32_t*) (file.data() + sizeof(MeshHeader) + header.vertexCount * sizeof(MeshVertex));
+    numVertices = header.vertexCount;
+    numIndices = header.indexCount;
+    return true;
+}
+
+void MeshFile::close() {
+    file.close();
+    vertexData = nullptr;
+    indexData = nullptr;
+    numVertices = 0;
+    numIndices = 0;
+}
+
+bool MeshFile::write(const std::string &path, uint64_t sourceHash, const Mesh &mesh) {
+    MeshHeader header = {};
+    memcpy(header.magic, MESH_MAGIC, 4);
+    header.version = VERSION;
+    header.sourceHash = sourceHash;
+    header.vertexCount = (uint32_t) mesh.vertices.size();
+    header.indexCount = (uint32_t) mesh.indices.size();
+    header.vertexSize = sizeof(MeshVertex);
+
+    std::string temporary = path + ".tmp";
+    FILE* out = fopen(temporary.c_str(), "wb");
+    if (!out) {
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1
+              && fwrite(mesh.vertices.data(), sizeof(MeshVertex), mesh.vertices.size(), out) == mesh.vertices.size()
+              && fwrite(mesh.indices.data(), sizeof(uint32_t), mesh.indices.size(), out) == mesh.indices.size();
+    ok = fclose(out) == 0 && ok;
+    std::error_code error;
+    if (ok) {
+        std::filesystem::rename(temporary, path, error);
+    }
+    if (!ok || error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+bool MeshAsset::load(const std::string &objPath, const std::string &cachePath) {
+    uint64_t sourceHash = hashFile(objPath);
+    if (cache.open(cachePath, sourceHash)) {
+        vertexData = cache.vertices();
+        indexData = cache.indices();
+        numVertices = cache.vertexCount();
+        numIndices = cache.indexCount();
+        return true;
+    }
+    if (!loadObjMesh(objPath, mesh)) {
+        std::cerr << "Could not load model " << objPath << std::endl;
+        return false;
+    }
+    // Triangle order first, the vertex order follows from it
+    optimizeVertexCache(mesh);
+    optimizeVertexFetch(mesh);
+    // Not being able to write the cache only costs the next start some time
+    if (!MeshFile::write(cachePath, sourceHash, mesh)) {
+        std::cout << "WARNING: could not write mesh cache " << cachePath << std::endl;
+    }
+    vertexData = mesh.vertices.data();
+    indexData = mesh.indices.data();
+    numVertices = mesh.vertices.size();
+    numIndices = mesh.indices.size();
+    return true;
+}
@@ -0,0 +1,112 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_MESH_H
+#define EXAMAUTUMN2023_MESH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// Same layout as the vertex attributes LoadModel sets up: position, normal, texture coordinates
+struct MeshVertex {
+    float position[3];
+    float normal[3];
+    float texCoords[2];
+};
+static_assert(sizeof(MeshVertex) == 8 * sizeof(float), "MeshVertex is uploaded as is");
+
+// Indexed triangle list
+struct Mesh {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+/**
+ * Parses an OBJ file with tinyobjloader into an indexed mesh. Face corners
+ * with the same position, normal and texture coordinates share one vertex,
+ * found by value through a hash map.
+ * @return false if the file could not be read or holds no triangles
+ */
+bool loadObjMesh(const std::string &path, Mesh &mesh);
+
+/**
+ * Reorders the triangles so that consecutive ones share vertices, after Tom
+ * Forsyth's linear-speed vertex cache optimisation: the GPU then finds most
+ * vertices already transformed in its post-transform cache.
+ */
+void optimizeVertexCache(Mesh &mesh);
+
+// Renumbers the vertices in the order the indices first use them, so vertex fetches walk the buffer forwards
+void optimizeVertexFetch(Mesh &mesh);
+
+// FNV-1a hash of a file's contents, 0 if it cannot be read
+uint64_t hashFile(const std::string &path);
+
+/**
+ * Binary cache of an indexed mesh: a 32 byte header, the vertices, then the
+ * 32-bit indices, all in host byte order since the cache never leaves the
+ * machine that wrote it. The header holds the hash of the OBJ file the mesh
+ * was converted from, so an edited model or a new format version makes the
+ * cache stale instead of wrong.
+ *
+ * The file is used in place from a memory mapping, the vertex and index
+ * arrays go straight to glBufferData without being copied or parsed.
+ */
+class MeshFile {
+private:
+    MappedFile file;
+    const MeshVertex* vertexData = nullptr;
+    const uint32_t* indexData = nullptr;
+    uint32_t numVertices = 0;
+    uint32_t numIndices = 0;
+
+public:
+    static constexpr uint32_t VERSION = 2;
+
+    // Fails on a missing or damaged file, or one written for another source hash or version
+    bool open(const std::string &path, uint64_t sourceHash);
+    void close();
+    bool isOpen() const { return vertexData != nullptr; }
+
+    const MeshVertex* vertices() const { return vertexData; }
+    const uint32_t* indices() const { return indexData; }
+    uint32_t vertexCount() const { return numVertices; }
+    uint32_t indexCount() const { return numIndices; }
+
+    // Writes to a temporary file first, so a reader never maps a half written cache
+    static bool write(const std::string &path, uint64_t sourceHash, const Mesh &mesh);
+};
+
+/**
+ * A model's mesh ready to upload, read from its cache when that is current and
+ * converted from the OBJ file otherwise (writing the cache for the next start).
+ * Loading touches no OpenGL state, so it runs on worker threads; only the
+ * upload of vertices() and indices() has to happen on the GL thread.
+ */
+class MeshAsset {
+private:
+    MeshFile cache;
+    Mesh mesh;
+    const MeshVertex* vertexData = nullptr;
+    const uint32_t* indexData = nullptr;
+    size_t numVertices = 0;
+    size_t numIndices = 0;
+
+public:
+    MeshAsset() = default;
+    MeshAsset(const MeshAsset&) = delete;
+    MeshAsset &operator=(const MeshAsset&) = delete;
+
+    // Returns false if there is neither a current cache nor a readable OBJ file
+    bool load(const std::string &objPath, const std::string &cachePath);
+
+    const MeshVertex* vertices() const { return vertexData; }
+    const uint32_t* indices() const { return indexData; }
+    size_t vertexCount() const { return numVertices; }
+    size_t indexCount() const { return numIndices; }
+};
+
+#endif //EXAMAUTUMN2023_MESH_H
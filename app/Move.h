@@ -0,0 +1,116 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_MOVE_H
+#define EXAMAUTUMN2023_MOVE_H
+
+#include <cstdint>
+#include <string>
+#include "ChessPiece.h"
+
+/**
+ * A move packed into 16 bits: bits 0-5 from square, bits 6-11 to square
+ * and bits 12-15 a flag describing the kind of move.
+ */
+typedef uint16_t Move;
+
+constexpr Move NO_MOVE = 0;
+
+enum MoveFlag {
+    QUIET = 0,
+    DOUBLE_PUSH = 1,
+    KING_CASTLE = 2,
+    QUEEN_CASTLE = 3,
+    CAPTURE = 4,
+    EP_CAPTURE = 5,
+    PROMOTION = 8,          // + 0-3 for knight, bishop, rook, queen
+    PROMOTION_CAPTURE = 12  // + 0-3 for knight, bishop, rook, queen
+};
+
+constexpr Move encodeMove(int from, int to, int flags = QUIET) {
+    return (Move) (from | (to << 6) | (flags << 12));
+}
+
+constexpr int moveFrom(Move m) {
+    return m & 0x3F;
+}
+
+constexpr int moveTo(Move m) {
+    return (m >> 6) & 0x3F;
+}
+
+constexpr int moveFlags(Move m) {
+    return m >> 12;
+}
+
+constexpr bool isCapture(Move m) {
+    return (moveFlags(m) & CAPTURE) != 0;
+}
+
+constexpr bool isPromotion(Move m) {
+    return (moveFlags(m) & PROMOTION) != 0;
+}
+
+constexpr bool isCastle(Move m) {
+    return moveFlags(m) == KING_CASTLE || moveFlags(m) == QUEEN_CASTLE;
+}
+
+constexpr ChessPieceType promotionType(Move m) {
+    switch (moveFlags(m) & 3) {
+        case 0: return KNIGHT;
+        case 1: return BISHOP;
+        case 2: return ROOK;
+        default: return QUEEN;
+    }
+}
+
+// Inverse of promotionType, used when building promotion moves
+constexpr int promotionFlag(ChessPieceType type) {
+    return type == KNIGHT ? 0 : type == BISHOP ? 1 : type == ROOK ? 2 : 3;
+}
+
+// Long algebraic notation as used by UCI, e.g. "e2e4" or "e7e8q"
+inline std::string moveToUci(Move m) {
+    if (m == NO_MOVE) {
+        return "0000";
+    }
+    std::string text;
+    text += (char) ('a' + (moveFrom(m) & 7));
+    text += (char) ('1' + (moveFrom(m) >> 3));
+    text += (char) ('a' + (moveTo(m) & 7));
+    text += (char) ('1' + (moveTo(m) >> 3));
+    if (isPromotion(m)) {
+        text += "nbrq"[moveFlags(m) & 3];
+    }
+    return text;
+}
+
+/**
+ * Fixed-capacity move list that lives on the stack. 256 is above the
+ * largest known number of legal moves in any chess position (218).
+ */
+struct MoveList {
+    Move moves[256];
+    int count = 0;
+
+    void add(Move m) { moves[count++] = m; }
+    int size() const { return count; }
+    void clear() { count = 0; }
+    Move operator[](int i) const { return moves[i]; }
+    Move* begin() { return moves; }
+    Move* end() { return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+
+    bool contains(Move m) const {
+        for (int i = 0; i < count; i++) {
+            if (moves[i] == m) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif //EXAMAUTUMN2023_MOVE_H
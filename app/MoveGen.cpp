@@ -0,0 +1,157 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "MoveGen.h"
+#include "Attacks.h"
+
+namespace {
+    // Adds a pawn move, expanding it to all four promotions on the last rank
+    void addPawnMove(MoveList &moves, int from, int to, int flags, bool tacticalOnly) {
+        if (rankOf(to) == 0 || rankOf(to) == 7) {
+            int promotionFlags = flags | PROMOTION;
+            moves.add(encodeMove(from, to, promotionFlags + promotionFlag(QUEEN)));
+            if (tacticalOnly) {
+                return;
+            }
+            moves.add(encodeMove(from, to, promotionFlags + promotionFlag(KNIGHT)));
+            moves.add(encodeMove(from, to, promotionFlags + promotionFlag(ROOK)));
+            moves.add(encodeMove(from, to, promotionFlags + promotionFlag(BISHOP)));
+        } else {
+            moves.add(encodeMove(from, to, flags));
+        }
+    }
+
+    // Our pieces that are the only blocker between our king and an enemy slider
+    Bitboard pinnedPieces(const Position &pos, Color us, int ksq) {
+        Color them = ~us;
+        Bitboard pinned = 0;
+        Bitboard snipers = (Attacks::rook(ksq, 0) & (pos.pieces(them, ROOK) | pos.pieces(them, QUEEN)))
+                         | (Attacks::bishop(ksq, 0) & (pos.pieces(them, BISHOP) | pos.pieces(them, QUEEN)));
+        while (snipers) {
+            Bitboard blockers = Attacks::between(ksq, popLsb(snipers)) & pos.occupied();
+            if (blockers && !(blockers & (blockers - 1)) && (blockers & pos.pieces(us))) {
+                pinned |= blockers;
+            }
+        }
+        return pinned;
+    }
+
+    bool isAttacked(const Position &pos, int sq, Color by) {
+        return (pos.attackersTo(sq, pos.occupied()) & pos.pieces(by)) != 0;
+    }
+
+    void generateCastling(const Position &pos, MoveList &moves, Color us) {
+        int base = us == WHITE ? 0 : 56;
+        int kingSide = us == WHITE ? WHITE_OO : BLACK_OO;
+        int queenSide = us == WHITE ? WHITE_OOO : BLACK_OOO;
+
+        if ((pos.castlingRights() & kingSide)
+            && pos.isEmpty(base + 5) && pos.isEmpty(base + 6)
+            && !isAttacked(pos, base + 5, ~us) && !isAttacked(pos, base + 6, ~us)) {
+            moves.add(encodeMove(base + 4, base + 6, KING_CASTLE));
+        }
+        if ((pos.castlingRights() & queenSide)
+            && pos.isEmpty(base + 1) && pos.isEmpty(base + 2) && pos.isEmpty(base + 3)
+            && !isAttacked(pos, base + 3, ~us) && !isAttacked(pos, base + 2, ~us)) {
+            moves.add(encodeMove(base + 4, base + 2, QUEEN_CASTLE));
+        }
+    }
+}
+
+void generateLegalMoves(const Position &pos, MoveList &moves, GenType type) {
+    Color us = pos.sideToMove();
+    Color them = ~us;
+    Bitboard ours = pos.pieces(us);
+    Bitboard theirs = pos.pieces(them);
+    Bitboard occupied = pos.occupied();
+    int ksq = pos.kingSquare(us);
+    Bitboard checkers = pos.attackersTo(ksq, occupied) & theirs;
+    // Out of check every evasion counts, quiet or not
+    bool tacticalOnly = type == TACTICAL_MOVES && !checkers;
+
+    // King moves. The king is removed from the occupancy so it cannot hide behind itself from a slider
+    Bitboard occupiedWithoutKing = occupied ^ squareBB(ksq);
+    Bitboard kingTargets = Attacks::king(ksq) & (tacticalOnly ? theirs : ~ours);
+    while (kingTargets) {
+        int to = popLsb(kingTargets);
+        if (!(pos.attackersTo(to, occupiedWithoutKing) & theirs)) {
+            moves.add(encodeMove(ksq, to, (theirs & squareBB(to)) ? CAPTURE : QUIET));
+        }
+    }
+
+    // In double check only the king can move
+    if (checkers & (checkers - 1)) {
+        return;
+    }
+
+    // In single check every other move must capture the checker or block the line to the king
+    Bitboard targetMask = tacticalOnly ? theirs : ~ours;
+    if (checkers) {
+        targetMask = Attacks::between(ksq, lsb(checkers)) | checkers;
+    } else if (!tacticalOnly) {
+        generateCastling(pos, moves, us);
+    }
+
+    Bitboard pinned = pinnedPieces(pos, us, ksq);
+
+    // Knights, bishops, rooks and queens. A pinned piece may only move along the pin line
+    const ChessPieceType pieceTypes[4] = {KNIGHT, BISHOP, ROOK, QUEEN};
+    for (auto pieceType : pieceTypes) {
+        Bitboard b = pos.pieces(us, pieceType);
+        while (b) {
+            int from = popLsb(b);
+            Bitboard targets = Attacks::piece(pieceType, from, occupied) & ~ours & targetMask;
+            if (pinned & squareBB(from)) {
+                targets &= Attacks::line(ksq, from);
+            }
+            while (targets) {
+                int to = popLsb(targets);
+                moves.add(encodeMove(from, to, (theirs & squareBB(to)) ? CAPTURE : QUIET));
+            }
+        }
+    }
+
+    // Pawns
+    int up = us == WHITE ? 8 : -8;
+    int startRank = us == WHITE ? 1 : 6;
+    int ep = pos.enPassantSquare();
+    Bitboard pawns = pos.pieces(us, PAWN);
+    while (pawns) {
+        int from = popLsb(pawns);
+        Bitboard allowed = targetMask;
+        if (pinned & squareBB(from)) {
+            allowed &= Attacks::line(ksq, from);
+        }
+
+        // Pushes. Tactical generation only keeps promotions, which are allowed onto any empty square
+        int to = from + up;
+        bool promotion = rankOf(to) == 0 || rankOf(to) == 7;
+        if (pos.isEmpty(to)) {
+            Bitboard pushMask = tacticalOnly ? (promotion ? ~occupied : 0) : allowed;
+            if (pinned & squareBB(from)) {
+                pushMask &= Attacks::line(ksq, from);
+            }
+            if (pushMask & squareBB(to)) {
+                addPawnMove(moves, from, to, QUIET, tacticalOnly);
+            }
+            if (!tacticalOnly && rankOf(from) == startRank && pos.isEmpty(to + up) && (allowed & squareBB(to + up))) {
+                moves.add(encodeMove(from, to + up, DOUBLE_PUSH));
+            }
+        }
+
+        Bitboard captures = Attacks::pawn(us, from) & theirs & allowed;
+        while (captures) {
+            addPawnMove(moves, from, popLsb(captures), CAPTURE, tacticalOnly);
+        }
+
+        // En passant removes two pieces from the same rank, so test the resulting occupancy directly
+        if (ep != NO_SQUARE && (Attacks::pawn(us, from) & squareBB(ep))) {
+            int captured = ep - up;
+            Bitboard occupiedAfter = (occupied ^ squareBB(from) ^ squareBB(captured)) | squareBB(ep);
+            if (!(pos.attackersTo(ksq, occupiedAfter) & theirs & ~squareBB(captured))) {
+                moves.add(encodeMove(from, ep, EP_CAPTURE));
+            }
+        }
+    }
+}
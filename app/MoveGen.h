@@ -0,0 +1,22 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_MOVEGEN_H
+#define EXAMAUTUMN2023_MOVEGEN_H
+
+#include "Move.h"
+#include "Position.h"
+
+enum GenType {
+    ALL_MOVES,
+    TACTICAL_MOVES  // Captures and promotions to a queen only, or every evasion when in check
+};
+
+/**
+ * Appends every legal move for the side to move in pos to moves.
+ * Legality comes from check and pin masks, no move is played to test it.
+ */
+void generateLegalMoves(const Position &pos, MoveList &moves, GenType type = ALL_MOVES);
+
+#endif //EXAMAUTUMN2023_MOVEGEN_H
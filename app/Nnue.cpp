@@ -0,0 +1,487 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Nnue.h"
+#include "Zobrist.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define NNUE_SSE2
+#include <emmintrin.h>
+#endif
+
+// GCC and Clang compile the AVX2 kernels for AVX2 alone and the CPU is checked at runtime,
+// so one binary runs everywhere. Other compilers only get them when building for AVX2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NNUE_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define NNUE_AVX2
+#define AVX2_TARGET
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#define NNUE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+    using namespace Nnue;
+
+    struct NetworkHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t features;
+        uint32_t hidden;
+        uint32_t l1;
+        uint32_t l2;
+        uint8_t reserved[40];
+    };
+    static_assert(sizeof(NetworkHeader) == 64, "NetworkHeader must stay 64 bytes");
+
+    const char NETWORK_MAGIC[4] = {'C', 'S', 'N', 'N'};
+    constexpr uint32_t NETWORK_VERSION = 1;
+
+    size_t align64(size_t offset) {
+        return (offset + 63) & ~(size_t) 63;
+    }
+
+    // Byte sizes of the arrays in file order
+    const size_t ARRAY_BYTES[] = {
+            HIDDEN * sizeof(int16_t), (size_t) FEATURES * HIDDEN * sizeof(int16_t),
+            L1 * sizeof(int32_t), L1 * 2 * HIDDEN * sizeof(int16_t),
+            L2 * sizeof(int32_t), L2 * L1 * sizeof(int16_t),
+            sizeof(int32_t), L2 * sizeof(int16_t)
+    };
+    constexpr int ARRAY_COUNT = sizeof(ARRAY_BYTES) / sizeof(ARRAY_BYTES[0]);
+
+    /**
+     * The kernels every layer runs through. affine() computes
+     * out[o] = bias[o] + sum of in[i] * weights[o * n + i] for o < outputs;
+     * n must be a multiple of 16.
+     */
+    struct Kernels {
+        const char* name;
+        void (*addRow)(int16_t* acc, const int16_t* row);
+        void (*subRow)(int16_t* acc, const int16_t* row);
+        void (*affine)(const int16_t* in, int n, const int16_t* weights, const int32_t* bias, int outputs, int32_t* out);
+    };
+
+    void addRowScalar(int16_t* acc, const int16_t* row) {
+        for (int i = 0; i < HIDDEN; i++) {
+            acc[i] = (int16_t) (acc[i] + row[i]);
+        }
+    }
+
+    void subRowScalar(int16_t* acc, const int16_t* row) {
+        for (int i = 0; i < HIDDEN; i++) {
+            acc[i] = (int16_t) (acc[i] - row[i]);
+        }
+    }
+
+    void affineScalar(const int16_t* in, int n, const int16_t* weights, const int32_t* bias, int outputs, int32_t* out) {
+        for (int o = 0; o < outputs; o++) {
+            int32_t sum = bias[o];
+            for (int i = 0; i < n; i++) {
+                sum += in[i] * weights[o * n + i];
+            }
+            out[o] = sum;
+        }
+    }
+
+#if defined(NNUE_SSE2)
+    void addRowSse2(int16_t* acc, const int16_t* row) {
+        for (int i = 0; i < HIDDEN; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i*) (acc + i));
+            __m128i w = _mm_loadu_si128((const __m128i*) (row + i));
+            _mm_storeu_si128((__m128i*) (acc + i), _mm_add_epi16(a, w));
+        }
+    }
+
+    void subRowSse2(int16_t* acc, const int16_t* row) {
+        for (int i = 0; i < HIDDEN; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i*) (acc + i));
+            __m128i w = _mm_loadu_si128((const __m128i*) (row + i));
+            _mm_storeu_si128((__m128i*) (acc + i), _mm_sub_epi16(a, w));
+        }
+    }
+
+    int32_t horizontalSumSse2(__m128i sum) {
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        return _mm_cvtsi128_si32(sum);
+    }
+
+    // Four outputs at a time, so every input load is shared by four weight rows
+    void affineSse2(const int16_t* in, int n, const int16_t* weights, const int32_t* bias, int outputs, int32_t* out) {
+        int o = 0;
+        for (; o + 4 <= outputs; o += 4) {
+            const int16_t* w = weights + o * n;
+            __m128i s0 = _mm_setzero_si128(), s1 = _mm_setzero_si128();
+            __m128i s2 = _mm_setzero_si128(), s3 = _mm_setzero_si128();
+            for (int i = 0; i < n; i += 8) {
+                __m128i x = _mm_loadu_si128((const __m128i*) (in + i));
+                s0 = _mm_add_epi32(s0, _mm_madd_epi16(x, _mm_loadu_si128((const __m128i*) (w + i))));
+                s1 = _mm_add_epi32(s1, _mm_madd_epi16(x, _mm_loadu_si128((const __m128i*) (w + n + i))));
+                s2 = _mm_add_epi32(s2, _mm_madd_epi16(x, _mm_loadu_si128((const __m128i*) (w + 2 * n + i))));
+                s3 = _mm_add_epi32(s3, _mm_madd_epi16(x, _mm_loadu_si128((const __m128i*) (w + 3 * n + i))));
+            }
+            out[o] = bias[o] + horizontalSumSse2(s0);
+            out[o + 1] = bias[o + 1] + horizontalSumSse2(s1);
+            out[o + 2] = bias[o + 2] + horizontalSumSse2(s2);
+            out[o + 3] = bias[o + 3] + horizontalSumSse2(s3);
+        }
+        for (; o < outputs; o++) {
+            __m128i sum = _mm_setzero_si128();
+            for (int i = 0; i < n; i += 8) {
+                __m128i x = _mm_loadu_si128((const __m128i*) (in + i));
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(x, _mm_loadu_si128((const __m128i*) (weights + o * n + i))));
+            }
+            out[o] = bias[o] + horizontalSumSse2(sum);
+        }
+    }
+#endif
+
+#if defined(NNUE_AVX2)
+    AVX2_TARGET void addRowAvx2(int16_t* acc, const int16_t* row) {
+        for (int i = 0; i < HIDDEN; i += 16) {
+            __m256i a = _mm256_loadu_si256((const __m256i*) (acc + i));
+            __m256i w = _mm256_loadu_si256((const __m256i*) (row + i));
+            _mm256_storeu_si256((__m256i*) (acc + i), _mm256_add_epi16(a, w));
+        }
+    }
+
+    AVX2_TARGET void subRowAvx2(int16_t* acc, const int16_t* row) {
+        for (int i = 0; i < HIDDEN; i += 16) {
+            __m256i a = _mm256_loadu_si256((const __m256i*) (acc + i));
+            __m256i w = _mm256_loadu_si256((const __m256i*) (row + i));
+            _mm256_storeu_si256((__m256i*) (acc + i), _mm256_sub_epi16(a, w));
+        }
+    }
+
+    // Four outputs at a time; the four sums are reduced together with horizontal adds
+    AVX2_TARGET void affineAvx2(const int16_t* in, int n, const int16_t* weights, const int32_t* bias, int outputs,
+                                int32_t* out) {
+        int o = 0;
+        for (; o + 4 <= outputs; o += 4) {
+            const int16_t* w = weights + o * n;
+            __m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();
+            __m256i s2 = _mm256_setzero_si256(), s3 = _mm256_setzero_si256();
+            for (int i = 0; i < n; i += 16) {
+                __m256i x = _mm256_loadu_si256((const __m256i*) (in + i));
+                s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(x, _mm256_loadu_si256((const __m256i*) (w + i))));
+                s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(x, _mm256_loadu_si256((const __m256i*) (w + n + i))));
+                s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(x, _mm256_loadu_si256((const __m256i*) (w + 2 * n + i))));
+                s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(x, _mm256_loadu_si256((const __m256i*) (w + 3 * n + i))));
+            }
+            __m256i sums = _mm256_hadd_epi32(_mm256_hadd_epi32(s0, s1), _mm256_hadd_epi32(s2, s3));
+            __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+            total = _mm_add_epi32(total, _mm_loadu_si128((const __m128i*) (bias + o)));
+            _mm_storeu_si128((__m128i*) (out + o), total);
+        }
+        for (; o < outputs; o++) {
+            __m256i sum = _mm256_setzero_si256();
+            for (int i = 0; i < n; i += 16) {
+                __m256i x = _mm256_loadu_si256((const __m256i*) (in + i));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(x, _mm256_loadu_si256((const __m256i*) (weights + o * n + i))));
+            }
+            __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+            out[o] = bias[o] + _mm_cvtsi128_si32(half);
+        }
+    }
+
+    bool cpuHasAvx2() {
+#if defined(__GNUC__)
+        return __builtin_cpu_supports("avx2");
+#else
+        return true;
+#endif
+    }
+#endif
+
+#if defined(NNUE_NEON)
+    void addRowNeon(int16_t* acc, const int16_t* row) {
+        for (int i = 0; i < HIDDEN; i += 8) {
+            vst1q_s16(acc + i, vaddq_s16(vld1q_s16(acc + i), vld1q_s16(row + i)));
+        }
+    }
+
+    void subRowNeon(int16_t* acc, const int16_t* row) {
+        for (int i = 0; i < HIDDEN; i += 8) {
+            vst1q_s16(acc + i, vsubq_s16(vld1q_s16(acc + i), vld1q_s16(row + i)));
+        }
+    }
+
+    void affineNeon(const int16_t* in, int n, const int16_t* weights, const int32_t* bias, int outputs, int32_t* out) {
+        for (int o = 0; o < outputs; o++) {
+            const int16_t* w = weights + o * n;
+            int32x4_t sum = vdupq_n_s32(0);
+            for (int i = 0; i < n; i += 8) {
+                int16x8_t x = vld1q_s16(in + i);
+                int16x8_t y = vld1q_s16(w + i);
+                sum = vmlal_s16(sum, vget_low_s16(x), vget_low_s16(y));
+                sum = vmlal_s16(sum, vget_high_s16(x), vget_high_s16(y));
+            }
+#if defined(__aarch64__)
+            out[o] = bias[o] + vaddvq_s32(sum);
+#else
+            out[o] = bias[o] + vgetq_lane_s32(sum, 0) + vgetq_lane_s32(sum, 1) + vgetq_lane_s32(sum, 2)
+                     + vgetq_lane_s32(sum, 3);
+#endif
+        }
+    }
+#endif
+
+    const Kernels SCALAR_KERNELS = {"scalar", addRowScalar, subRowScalar, affineScalar};
+#if defined(NNUE_SSE2)
+    const Kernels SSE2_KERNELS = {"sse2", addRowSse2, subRowSse2, affineSse2};
+#endif
+#if defined(NNUE_AVX2)
+    const Kernels AVX2_KERNELS = {"avx2", addRowAvx2, subRowAvx2, affineAvx2};
+#endif
+#if defined(NNUE_NEON)
+    const Kernels NEON_KERNELS = {"neon", addRowNeon, subRowNeon, affineNeon};
+#endif
+
+    const Kernels* bestKernels() {
+#if defined(NNUE_AVX2)
+        if (cpuHasAvx2()) {
+            return &AVX2_KERNELS;
+        }
+#endif
+#if defined(NNUE_SSE2)
+        return &SSE2_KERNELS;
+#elif defined(NNUE_NEON)
+        return &NEON_KERNELS;
+#else
+        return &SCALAR_KERNELS;
+#endif
+    }
+
+    const Kernels* kernels = bestKernels();
+
+    // Features are seen from perspective's side: black's view is the board flipped vertically
+    int featureIndex(Color perspective, int kingSq, int piece, int sq) {
+        if (perspective == BLACK) {
+            kingSq ^= 56;
+            sq ^= 56;
+        }
+        int pieceIndex = typeOf(piece) * 2 + (colorOf(piece) != perspective ? 1 : 0);
+        return kingSq * 640 + pieceIndex * 64 + sq;
+    }
+
+    int16_t clippedRelu(int value) {
+        return (int16_t) std::clamp(value, 0, ACTIVATION_MAX);
+    }
+}
+
+const char* Nnue::kernelName() {
+    return kernels->name;
+}
+
+bool Nnue::selectKernels(const std::string &name) {
+    if (name == "auto") {
+        kernels = bestKernels();
+        return true;
+    }
+    if (name == "scalar") {
+        kernels = &SCALAR_KERNELS;
+        return true;
+    }
+#if defined(NNUE_SSE2)
+    if (name == "sse2") {
+        kernels = &SSE2_KERNELS;
+        return true;
+    }
+#endif
+#if defined(NNUE_AVX2)
+    if (name == "avx2" && cpuHasAvx2()) {
+        kernels = &AVX2_KERNELS;
+        return true;
+    }
+#endif
+#if defined(NNUE_NEON)
+    if (name == "neon") {
+        kernels = &NEON_KERNELS;
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool Nnue::Network::load(const std::string &path) {
+    featureWeights = nullptr;
+    if (!file.open(path, MappedFile::RANDOM) || file.size() < sizeof(NetworkHeader)) {
+        file.close();
+        return false;
+    }
+    auto header = reinterpret_cast<const NetworkHeader*>(file.data());
+    if (memcmp(header->magic, NETWORK_MAGIC, 4) != 0 || header->version != NETWORK_VERSION
+        || header->features != FEATURES || header->hidden != HIDDEN || header->l1 != L1 || header->l2 != L2) {
+        file.close();
+        return false;
+    }
+
+    const char* arrays[ARRAY_COUNT];
+    size_t offset = sizeof(NetworkHeader);
+    for (int i = 0; i < ARRAY_COUNT; i++) {
+        if (offset + ARRAY_BYTES[i] > file.size()) {
+            file.close();
+            return false;
+        }
+        arrays[i] = file.data() + offset;
+        offset = align64(offset + ARRAY_BYTES[i]);
+    }
+    featureBias = reinterpret_cast<const int16_t*>(arrays[0]);
+    l1Bias = reinterpret_cast<const int32_t*>(arrays[2]);
+    l1Weights = reinterpret_cast<const int16_t*>(arrays[3]);
+    l2Bias = reinterpret_cast<const int32_t*>(arrays[4]);
+    l2Weights = reinterpret_cast<const int16_t*>(arrays[5]);
+    outputBias = reinterpret_cast<const int32_t*>(arrays[6]);
+    outputWeights = reinterpret_cast<const int16_t*>(arrays[7]);
+    featureWeights = reinterpret_cast<const int16_t*>(arrays[1]);
+    return true;
+}
+
+void Nnue::Network::refresh(Accumulator &acc, Color perspective, const Position &pos) const {
+    int16_t* values = acc.values[perspective];
+    memcpy(values, featureBias, sizeof(acc.values[perspective]));
+    int kingSq = pos.kingSquare(perspective);
+    for (Bitboard b = pos.occupied() & ~pos.pieces(WHITE, KING) & ~pos.pieces(BLACK, KING); b; ) {
+        int sq = popLsb(b);
+        kernels->addRow(values, featureWeights + (size_t) featureIndex(perspective, kingSq, pos.pieceOn(sq), sq) * HIDDEN);
+    }
+}
+
+void Nnue::Network::refresh(Accumulator &acc, const Position &pos) const {
+    refresh(acc, WHITE, pos);
+    refresh(acc, BLACK, pos);
+}
+
+void Nnue::Network::update(const Accumulator &prev, Accumulator &next, const Position &pos, Move m,
+                           const UndoRecord &undo) const {
+    int from = moveFrom(m);
+    int to = moveTo(m);
+    int placed = pos.pieceOn(to);
+    Color us = colorOf(placed);
+    int moved = isPromotion(m) ? makePiece(PAWN, us) : placed;
+
+    // At most three features go (mover, captured piece, castling rook) and two come
+    int removedPieces[3], removedSquares[3], addedPieces[2], addedSquares[2];
+    int removedCount = 0, addedCount = 0;
+    removedPieces[removedCount] = moved;
+    removedSquares[removedCount++] = from;
+    addedPieces[addedCount] = placed;
+    addedSquares[addedCount++] = to;
+    if (undo.captured != NO_PIECE) {
+        removedPieces[removedCount] = undo.captured;
+        removedSquares[removedCount++] = moveFlags(m) == EP_CAPTURE ? (us == WHITE ? to - 8 : to + 8) : to;
+    }
+    if (isCastle(m)) {
+        int rook = makePiece(ROOK, us);
+        bool kingSide = moveFlags(m) == KING_CASTLE;
+        removedPieces[removedCount] = rook;
+        removedSquares[removedCount++] = kingSide ? to + 1 : to - 2;
+        addedPieces[addedCount] = rook;
+        addedSquares[addedCount++] = kingSide ? to - 1 : to + 1;
+    }
+
+    for (Color perspective : {WHITE, BLACK}) {
+        // Every feature of this side depends on its king square
+        if (typeOf(moved) == KING && us == perspective) {
+            refresh(next, perspective, pos);
+            continue;
+        }
+        int16_t* values = next.values[perspective];
+        memcpy(values, prev.values[perspective], sizeof(next.values[perspective]));
+        int kingSq = pos.kingSquare(perspective);
+        for (int i = 0; i < removedCount; i++) {
+            if (typeOf(removedPieces[i]) != KING) {
+                kernels->subRow(values, featureWeights
+                                        + (size_t) featureIndex(perspective, kingSq, removedPieces[i], removedSquares[i]) * HIDDEN);
+            }
+        }
+        for (int i = 0; i < addedCount; i++) {
+            if (typeOf(addedPieces[i]) != KING) {
+                kernels->addRow(values, featureWeights
+                                        + (size_t) featureIndex(perspective, kingSq, addedPieces[i], addedSquares[i]) * HIDDEN);
+            }
+        }
+    }
+}
+
+int Nnue::Network::evaluate(const Accumulator &acc, Color sideToMove) const {
+    // The side to move's half comes first, so the network knows whose turn it is
+    alignas(64) int16_t input[2 * HIDDEN];
+    for (int i = 0; i < HIDDEN; i++) {
+        input[i] = clippedRelu(acc.values[sideToMove][i]);
+        input[HIDDEN + i] = clippedRelu(acc.values[~sideToMove][i]);
+    }
+    alignas(64) int32_t sums[L1 > L2 ? L1 : L2];
+    alignas(64) int16_t hidden1[L1];
+    kernels->affine(input, 2 * HIDDEN, l1Weights, l1Bias, L1, sums);
+    for (int i = 0; i < L1; i++) {
+        hidden1[i] = clippedRelu(sums[i] >> WEIGHT_SHIFT);
+    }
+    alignas(64) int16_t hidden2[L2];
+    kernels->affine(hidden1, L1, l2Weights, l2Bias, L2, sums);
+    for (int i = 0; i < L2; i++) {
+        hidden2[i] = clippedRelu(sums[i] >> WEIGHT_SHIFT);
+    }
+    int32_t output;
+    kernels->affine(hidden2, L2, outputWeights, outputBias, 1, &output);
+    return output / OUTPUT_DIVISOR;
+}
+
+bool Nnue::Network::writeRandom(const std::string &path, uint64_t seed) {
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) {
+        return false;
+    }
+    NetworkHeader header = {};
+    memcpy(header.magic, NETWORK_MAGIC, 4);
+    header.version = NETWORK_VERSION;
+    header.features = FEATURES;
+    header.hidden = HIDDEN;
+    header.l1 = L1;
+    header.l2 = L2;
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+
+    auto next = [&seed]() {
+        return Zobrist::splitMix64(seed);
+    };
+    // Per array: element size and the half-width of the uniform range its values are drawn from
+    const int elementSizes[ARRAY_COUNT] = {2, 2, 4, 2, 4, 2, 4, 2};
+    const int ranges[ARRAY_COUNT] = {32, 8, 256, 64, 256, 64, 0, 64};
+    static const char padding[64] = {};
+    std::vector<char> buffer;
+    size_t offset = sizeof(NetworkHeader);
+    for (int i = 0; i < ARRAY_COUNT && ok; i++) {
+        size_t count = ARRAY_BYTES[i] / elementSizes[i];
+        buffer.resize(ARRAY_BYTES[i]);
+        for (size_t j = 0; j < count; j++) {
+            int value = (int) (next() % (2 * ranges[i] + 1)) - ranges[i];
+            if (elementSizes[i] == 2) {
+                int16_t v = (int16_t) value;
+                memcpy(buffer.data() + j * 2, &v, 2);
+            } else {
+                int32_t v = value;
+                memcpy(buffer.data() + j * 4, &v, 4);
+            }
+        }
+        size_t end = align64(offset + ARRAY_BYTES[i]);
+        ok = fwrite(buffer.data(), 1, buffer.size(), out) == buffer.size()
+             && fwrite(padding, 1, end - offset - ARRAY_BYTES[i], out) == end - offset - ARRAY_BYTES[i];
+        offset = end;
+    }
+    ok = fclose(out) == 0 && ok;
+    return ok;
+}
@@ -0,0 +1,92 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_NNUE_H
+#define EXAMAUTUMN2023_NNUE_H
+
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+#include "Move.h"
+#include "Position.h"
+
+/**
+ * Efficiently updatable neural network evaluation.
+ *
+ * Input features are HalfKP: for each side ("perspective"), every non-king
+ * piece on the board combined with that side's king square, 64 * 640
+ * features. The first layer's output for both perspectives lives in an
+ * Accumulator. A move only turns two or three features off and on, so the
+ * accumulator after a move is the one before plus and minus a few weight
+ * rows; only a king move rebuilds that side's half from scratch.
+ *
+ * The rest is small int16 affine layers with clipped ReLU between them:
+ * 2 x 256 -> 32 -> 32 -> 1. The hot loops run through kernels picked at
+ * startup for the CPU at hand: AVX2, SSE2, NEON or plain C++.
+ */
+namespace Nnue {
+    constexpr int FEATURES = 64 * 640;
+    constexpr int HIDDEN = 256;         // First layer outputs per perspective
+    constexpr int L1 = 32;
+    constexpr int L2 = 32;
+    constexpr int ACTIVATION_MAX = 127; // Clipped ReLU range
+    constexpr int WEIGHT_SHIFT = 6;     // Hidden layer weights are scaled by 2^6
+    constexpr int OUTPUT_DIVISOR = 16;  // Network output units per centipawn
+
+    struct alignas(64) Accumulator {
+        int16_t values[2][HIDDEN];      // Indexed by perspective
+    };
+
+    // Names the kernels in use: "avx2", "sse2", "neon" or "scalar"
+    const char* kernelName();
+    // Switches kernels, for benchmarks and testing; "auto" picks the best the CPU supports.
+    // Returns false if name is unknown or not supported here
+    bool selectKernels(const std::string &name);
+
+    /**
+     * Network weights, used in place from a memory-mapped file. The file is a
+     * 64 byte header ("CSNN", version, layer sizes) followed by the arrays,
+     * each starting on a 64 byte boundary, little-endian:
+     *   int16 featureBias[256], int16 featureWeights[40960][256],
+     *   int32 l1Bias[32], int16 l1Weights[32][512],
+     *   int32 l2Bias[32], int16 l2Weights[32][32],
+     *   int32 outputBias, int16 outputWeights[32]
+     */
+    class Network {
+    private:
+        MappedFile file;
+        const int16_t* featureBias = nullptr;
+        const int16_t* featureWeights = nullptr;
+        const int32_t* l1Bias = nullptr;
+        const int16_t* l1Weights = nullptr;
+        const int32_t* l2Bias = nullptr;
+        const int16_t* l2Weights = nullptr;
+        const int32_t* outputBias = nullptr;
+        const int16_t* outputWeights = nullptr;
+
+    public:
+        // Fails, leaving no network loaded, if path is missing or not a network of this shape
+        bool load(const std::string &path);
+        bool isLoaded() const { return featureWeights != nullptr; }
+
+        // Builds perspective's half of acc from the pieces of pos
+        void refresh(Accumulator &acc, Color perspective, const Position &pos) const;
+        void refresh(Accumulator &acc, const Position &pos) const;
+        /**
+         * Fills next from prev for a move that has just been made.
+         * @param pos  - the position after m
+         * @param undo - the record makeMove filled, for the captured piece
+         */
+        void update(const Accumulator &prev, Accumulator &next, const Position &pos, Move m,
+                    const UndoRecord &undo) const;
+        // Score in centipawns from the point of view of sideToMove
+        int evaluate(const Accumulator &acc, Color sideToMove) const;
+
+        // Writes a network with small random weights: a stand-in with the right shape and cost
+        // for benchmarking and testing before a trained network exists
+        static bool writeRandom(const std::string &path, uint64_t seed);
+    };
+}
+
+#endif //EXAMAUTUMN2023_NNUE_H
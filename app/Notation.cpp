@@ -0,0 +1,174 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Notation.h"
+#include "MoveGen.h"
+
+namespace {
+    // SAN letters indexed by ChessPieceType, pawns have none
+    const char PIECE_LETTERS[6] = {'\0', 'R', 'N', 'B', 'Q', 'K'};
+
+    ChessPieceType pieceFromLetter(char c) {
+        switch (c) {
+            case 'R': return ROOK;
+            case 'N': return KNIGHT;
+            case 'B': return BISHOP;
+            case 'Q': return QUEEN;
+            case 'K': return KING;
+            default: return PAWN;
+        }
+    }
+
+    bool isFileChar(char c) { return c >= 'a' && c <= 'h'; }
+    bool isRankChar(char c) { return c >= '1' && c <= '8'; }
+}
+
+std::string moveToSan(const Position &pos, Move m) {
+    std::string san;
+    int from = moveFrom(m);
+    int to = moveTo(m);
+    int flags = moveFlags(m);
+
+    if (flags == KING_CASTLE) {
+        san = "O-O";
+    } else if (flags == QUEEN_CASTLE) {
+        san = "O-O-O";
+    } else {
+        ChessPieceType type = typeOf(pos.pieceOn(from));
+        if (type == PAWN) {
+            if (isCapture(m)) {
+                san += (char) ('a' + fileOf(from));
+            }
+        } else {
+            san += PIECE_LETTERS[type];
+            // Other pieces of the same type that can reach the same square
+            MoveList moves;
+            generateLegalMoves(pos, moves);
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            for (Move other : moves) {
+                int otherFrom = moveFrom(other);
+                if (otherFrom != from && moveTo(other) == to && typeOf(pos.pieceOn(otherFrom)) == type) {
+                    ambiguous = true;
+                    sameFile |= fileOf(otherFrom) == fileOf(from);
+                    sameRank |= rankOf(otherFrom) == rankOf(from);
+                }
+            }
+            if (ambiguous) {
+                if (!sameFile) {
+                    san += (char) ('a' + fileOf(from));
+                } else if (!sameRank) {
+                    san += (char) ('1' + rankOf(from));
+                } else {
+                    san += (char) ('a' + fileOf(from));
+                    san += (char) ('1' + rankOf(from));
+                }
+            }
+        }
+        if (isCapture(m)) {
+            san += 'x';
+        }
+        san += (char) ('a' + fileOf(to));
+        san += (char) ('1' + rankOf(to));
+        if (isPromotion(m)) {
+            san += '=';
+            san += PIECE_LETTERS[promotionType(m)];
+        }
+    }
+
+    Position after = pos;
+    UndoRecord undo;
+    after.makeMove(m, undo);
+    if (after.inCheck()) {
+        MoveList replies;
+        generateLegalMoves(after, replies);
+        san += replies.size() == 0 ? '#' : '+';
+    }
+    return san;
+}
+
+Move parseSan(const Position &pos, std::string_view san) {
+    MoveList moves;
+    generateLegalMoves(pos, moves);
+    return parseSan(pos, san, moves);
+}
+
+Move parseSan(const Position &pos, std::string_view san, const MoveList &moves) {
+    // Drop check marks and annotation glyphs
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) {
+        san.remove_suffix(1);
+    }
+    if (san.empty()) {
+        return NO_MOVE;
+    }
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        int flag = san.size() == 3 ? KING_CASTLE : QUEEN_CASTLE;
+        for (Move m : moves) {
+            if (moveFlags(m) == flag) {
+                return m;
+            }
+        }
+        return NO_MOVE;
+    }
+
+    // Promotion suffix, "e8=Q" or the older "e8Q"
+    ChessPieceType promotion = PAWN;
+    if (pieceFromLetter(san.back()) != PAWN && san.size() > 2) {
+        promotion = pieceFromLetter(san.back());
+        san.remove_suffix(1);
+        if (san.back() == '=') {
+            san.remove_suffix(1);
+        }
+    }
+
+    ChessPieceType type = PAWN;
+    if (pieceFromLetter(san.front()) != PAWN) {
+        type = pieceFromLetter(san.front());
+        san.remove_prefix(1);
+    }
+
+    // The destination is the last two characters, what is left before it disambiguates
+    if (san.size() < 2 || !isFileChar(san[san.size() - 2]) || !isRankChar(san.back())) {
+        return NO_MOVE;
+    }
+    int to = (san.back() - '1') * 8 + (san[san.size() - 2] - 'a');
+    san.remove_suffix(2);
+    int fromFile = -1, fromRank = -1;
+    for (char c : san) {
+        if (isFileChar(c)) {
+            fromFile = c - 'a';
+        } else if (isRankChar(c)) {
+            fromRank = c - '1';
+        } else if (c != 'x' && c != ':' && c != '-') {
+            return NO_MOVE;
+        }
+    }
+
+    Move found = NO_MOVE;
+    for (Move m : moves) {
+        int from = moveFrom(m);
+        if (moveTo(m) != to || typeOf(pos.pieceOn(from)) != type || isCastle(m)
+            || (fromFile >= 0 && fileOf(from) != fromFile)
+            || (fromRank >= 0 && rankOf(from) != fromRank)
+            || (isPromotion(m) ? promotionType(m) != promotion : promotion != PAWN)) {
+            continue;
+        }
+        if (found != NO_MOVE) {
+            return NO_MOVE;
+        }
+        found = m;
+    }
+    return found;
+}
+
+Move parseUciMove(const Position &pos, std::string_view text) {
+    MoveList moves;
+    generateLegalMoves(pos, moves);
+    for (Move m : moves) {
+        if (moveToUci(m) == text) {
+            return m;
+        }
+    }
+    return NO_MOVE;
+}
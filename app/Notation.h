@@ -0,0 +1,30 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_NOTATION_H
+#define EXAMAUTUMN2023_NOTATION_H
+
+#include <string>
+#include <string_view>
+#include "Move.h"
+#include "Position.h"
+
+/**
+ * Standard Algebraic Notation of a legal move in pos, e.g. "Nbd7", "exd6",
+ * "e8=Q+" or "O-O-O#". Disambiguates by file, then rank, then both.
+ */
+std::string moveToSan(const Position &pos, Move m);
+
+/**
+ * The legal move a SAN token describes, or NO_MOVE if it matches none or is ambiguous.
+ * Accepts check marks and annotations ("+", "#", "!?") and "0-0" for castling.
+ */
+Move parseSan(const Position &pos, std::string_view san);
+// Same with the legal moves of pos already generated
+Move parseSan(const Position &pos, std::string_view san, const MoveList &moves);
+
+// The legal move in coordinate notation like "e7e8q", or NO_MOVE
+Move parseUciMove(const Position &pos, std::string_view text);
+
+#endif //EXAMAUTUMN2023_NOTATION_H
@@ -0,0 +1,241 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "PackedFormat.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const char POSITION_MAGIC[4] = {'C', 'S', 'P', 'F'};
+    const char GAME_MAGIC[4] = {'C', 'S', 'G', 'F'};
+    const char INDEX_MAGIC[8] = {'C', 'S', 'G', 'F', 'I', 'D', 'X', '\0'};
+    constexpr uint16_t FORMAT_VERSION = 1;
+
+    // Records are padded so every PackedPosition in the mapping is 8-byte aligned
+    size_t padTo8(size_t bytes) {
+        return (bytes + 7) & ~(size_t) 7;
+    }
+
+    FileHeader makeHeader(const char magic[4], uint16_t recordSize) {
+        FileHeader header = {};
+        memcpy(header.magic, magic, 4);
+        header.version = FORMAT_VERSION;
+        header.recordSize = recordSize;
+        return header;
+    }
+
+    bool checkHeader(const MappedFile &file, const char magic[4], uint16_t recordSize) {
+        if (file.size() < sizeof(FileHeader)) {
+            return false;
+        }
+        auto header = reinterpret_cast<const FileHeader*>(file.data());
+        return memcmp(header->magic, magic, 4) == 0 && header->version == FORMAT_VERSION
+               && header->recordSize == recordSize;
+    }
+}
+
+PackedPosition packPosition(const Position &pos, int score, GameResult result) {
+    PackedPosition packed = {};
+    packed.occupancy = pos.occupied();
+    int i = 0;
+    for (Bitboard b = pos.occupied(); b && i < 32; i++) {
+        packed.pieces[i / 2] |= (uint8_t) (pos.pieceOn(popLsb(b)) << (4 * (i & 1)));
+    }
+    packed.flags = (uint8_t) ((pos.sideToMove() == BLACK ? 1 : 0) | pos.castlingRights() << 1);
+    packed.epSquare = (uint8_t) pos.enPassantSquare();
+    packed.halfmoveClock = (uint8_t) std::min(pos.halfmoves(), 255);
+    packed.result = result;
+    packed.fullmoveNumber = (uint16_t) std::min(pos.fullmoves(), 65535);
+    packed.score = (int16_t) std::max(-32767, std::min(score, 32767));
+    return packed;
+}
+
+bool unpackPosition(const PackedPosition &packed, Position &pos) {
+    pos.clear();
+    if (popCount(packed.occupancy) > 32) {
+        return false;
+    }
+    int i = 0;
+    for (Bitboard b = packed.occupancy; b; i++) {
+        int piece = (packed.pieces[i / 2] >> (4 * (i & 1))) & 0xF;
+        if (piece >= NO_PIECE) {
+            pos.clear();
+            return false;
+        }
+        pos.putPiece(piece, popLsb(b));
+    }
+    if (popCount(pos.pieces(WHITE, KING)) != 1 || popCount(pos.pieces(BLACK, KING)) != 1) {
+        pos.clear();
+        return false;
+    }
+    pos.setState(packed.flags & 1 ? BLACK : WHITE, packed.flags >> 1, packed.epSquare,
+                 packed.halfmoveClock, packed.fullmoveNumber);
+    return true;
+}
+
+GameResult parseResult(std::string_view pgnResult) {
+    if (pgnResult == "1-0") return WHITE_WINS;
+    if (pgnResult == "0-1") return BLACK_WINS;
+    if (pgnResult == "1/2-1/2") return DRAW;
+    return UNKNOWN_RESULT;
+}
+
+const char* resultToPgn(GameResult result) {
+    switch (result) {
+        case WHITE_WINS: return "1-0";
+        case BLACK_WINS: return "0-1";
+        case DRAW: return "1/2-1/2";
+        default: return "*";
+    }
+}
+
+PositionWriter::~PositionWriter() {
+    close();
+}
+
+bool PositionWriter::open(const std::string &path) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    FileHeader header = makeHeader(POSITION_MAGIC, sizeof(PackedPosition));
+    count = 0;
+    return fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+bool PositionWriter::write(const PackedPosition &position) {
+    return write(&position, 1);
+}
+
+bool PositionWriter::write(const PackedPosition* positions, size_t n) {
+    if (!file || fwrite(positions, sizeof(PackedPosition), n, file) != n) {
+        return false;
+    }
+    count += n;
+    return true;
+}
+
+bool PositionWriter::close() {
+    if (!file) {
+        return true;
+    }
+    bool ok = fclose(file) == 0;
+    file = nullptr;
+    return ok;
+}
+
+bool PositionReader::open(const std::string &path, MappedFile::AccessPattern pattern) {
+    records = nullptr;
+    count = 0;
+    if (!file.open(path, pattern) || !checkHeader(file, POSITION_MAGIC, sizeof(PackedPosition))) {
+        file.close();
+        return false;
+    }
+    records = reinterpret_cast<const PackedPosition*>(file.data() + sizeof(FileHeader));
+    count = (file.size() - sizeof(FileHeader)) / sizeof(PackedPosition);
+    return true;
+}
+
+GameWriter::~GameWriter() {
+    close();
+}
+
+bool GameWriter::open(const std::string &path) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    index.clear();
+    FileHeader header = makeHeader(GAME_MAGIC, 0);
+    offset = sizeof(header);
+    return fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+bool GameWriter::addGame(const Position &start, const Move* moves, int count, GameResult result) {
+    return addGame(packPosition(start, 0, result), moves, count);
+}
+
+bool GameWriter::addGame(const PackedPosition &start, const Move* moves, int count) {
+    if (!file || count < 0 || count > 65535) {
+        return false;
+    }
+    PackedGameHeader header = {};
+    header.start = start;
+    header.moveCount = (uint16_t) count;
+    header.result = start.result;
+
+    static const char padding[8] = {};
+    size_t moveBytes = (size_t) count * sizeof(Move);
+    size_t paddingBytes = padTo8(moveBytes) - moveBytes;
+    if (fwrite(&header, sizeof(header), 1, file) != 1
+        || fwrite(moves, sizeof(Move), (size_t) count, file) != (size_t) count
+        || fwrite(padding, 1, paddingBytes, file) != paddingBytes) {
+        return false;
+    }
+    index.push_back(offset);
+    offset += sizeof(header) + moveBytes + paddingBytes;
+    return true;
+}
+
+bool GameWriter::close() {
+    if (!file) {
+        return true;
+    }
+    GameFileFooter footer = {};
+    footer.indexOffset = offset;
+    footer.gameCount = index.size();
+    memcpy(footer.magic, INDEX_MAGIC, sizeof(footer.magic));
+    bool ok = fwrite(index.data(), sizeof(uint64_t), index.size(), file) == index.size()
+              && fwrite(&footer, sizeof(footer), 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+bool GameReader::open(const std::string &path, MappedFile::AccessPattern pattern) {
+    index = nullptr;
+    count = 0;
+    if (!file.open(path, pattern) || !checkHeader(file, GAME_MAGIC, 0)
+        || file.size() < sizeof(FileHeader) + sizeof(GameFileFooter)) {
+        file.close();
+        return false;
+    }
+    auto footer = reinterpret_cast<const GameFileFooter*>(file.data() + file.size() - sizeof(GameFileFooter));
+    size_t indexEnd = file.size() - sizeof(GameFileFooter);
+    if (memcmp(footer->magic, INDEX_MAGIC, sizeof(footer->magic)) != 0 || footer->indexOffset > indexEnd
+        || footer->indexOffset % 8 != 0 || (indexEnd - footer->indexOffset) / sizeof(uint64_t) != footer->gameCount) {
+        file.close();
+        return false;
+    }
+    index = reinterpret_cast<const uint64_t*>(file.data() + footer->indexOffset);
+    count = footer->gameCount;
+    gameAreaEnd = footer->indexOffset;
+    // Every game header has to lie inside the game area; its move count is checked by game(), so
+    // opening reads only the index and leaves the game pages unmapped. The bounds are compared by
+    // subtracting from the index offset, so a damaged offset cannot overflow past them
+    for (size_t i = 0; i < count; i++) {
+        uint64_t offset = index[i];
+        if (offset < sizeof(FileHeader) || offset % 8 != 0 || gameAreaEnd < sizeof(PackedGameHeader)
+            || offset > gameAreaEnd - sizeof(PackedGameHeader)) {
+            index = nullptr;
+            count = 0;
+            file.close();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GameReader::game(size_t i, GameView &view) const {
+    auto header = reinterpret_cast<const PackedGameHeader*>(file.data() + index[i]);
+    if (header->moveCount > (gameAreaEnd - index[i] - sizeof(PackedGameHeader)) / sizeof(Move)) {
+        return false;
+    }
+    view = {header, reinterpret_cast<const Move*>(header + 1)};
+    return true;
+}
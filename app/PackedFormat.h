@@ -0,0 +1,158 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_PACKEDFORMAT_H
+#define EXAMAUTUMN2023_PACKEDFORMAT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+#include "Move.h"
+#include "Position.h"
+
+/**
+ * Binary position and game files, read in place from a memory mapping.
+ *
+ * Every file starts with a 16 byte FileHeader. A position file is followed by
+ * PackedPosition records back to back. A game file holds records made of a
+ * PackedGameHeader and the 16-bit moves, each padded to 8 bytes, followed by
+ * one 64-bit offset per game and a GameFileFooter, so game i is one lookup
+ * away. Multi-byte fields are stored little-endian, the native order of the
+ * machines we run on.
+ */
+
+enum GameResult : uint8_t {
+    BLACK_WINS = 0,
+    DRAW = 1,
+    WHITE_WINS = 2,
+    UNKNOWN_RESULT = 3
+};
+
+// 32 bytes: which squares are occupied, then one 4-bit piece code per occupied square in square order
+struct PackedPosition {
+    uint64_t occupancy;
+    uint8_t pieces[16];
+    uint8_t flags;              // Bit 0: black to move, bits 1-4: CastlingRight bits
+    uint8_t epSquare;
+    uint8_t halfmoveClock;
+    uint8_t result;             // GameResult of the game the position is from
+    uint16_t fullmoveNumber;
+    int16_t score;              // Search score from the side to move's view, 0 if unknown
+};
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+
+struct FileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t recordSize;        // sizeof(PackedPosition) for position files, 0 for game files
+    uint64_t reserved;
+};
+static_assert(sizeof(FileHeader) == 16, "FileHeader must stay 16 bytes");
+
+struct PackedGameHeader {
+    PackedPosition start;
+    uint16_t moveCount;
+    uint8_t result;
+    uint8_t reserved[5];
+};
+static_assert(sizeof(PackedGameHeader) == 40, "PackedGameHeader must stay 40 bytes");
+
+struct GameFileFooter {
+    uint64_t indexOffset;       // File offset of the game offset table
+    uint64_t gameCount;
+    char magic[8];
+};
+
+PackedPosition packPosition(const Position &pos, int score = 0, GameResult result = UNKNOWN_RESULT);
+// Returns false and leaves pos empty if packed does not hold one king per side
+bool unpackPosition(const PackedPosition &packed, Position &pos);
+
+GameResult parseResult(std::string_view pgnResult);
+const char* resultToPgn(GameResult result);
+
+// A game inside a mapped game file
+struct GameView {
+    const PackedGameHeader* header;
+    const Move* moves;
+
+    int moveCount() const { return header->moveCount; }
+    GameResult result() const { return (GameResult) header->result; }
+};
+
+// Appends records to a position file
+class PositionWriter {
+private:
+    FILE* file = nullptr;
+    uint64_t count = 0;
+
+public:
+    PositionWriter() = default;
+    ~PositionWriter();
+    PositionWriter(const PositionWriter&) = delete;
+    PositionWriter &operator=(const PositionWriter&) = delete;
+
+    bool open(const std::string &path);
+    bool write(const PackedPosition &position);
+    bool write(const PackedPosition* positions, size_t n);
+    bool close();
+    uint64_t written() const { return count; }
+};
+
+// Zero-copy view of a position file: the records are used straight from the mapping
+class PositionReader {
+private:
+    MappedFile file;
+    const PackedPosition* records = nullptr;
+    size_t count = 0;
+
+public:
+    bool open(const std::string &path, MappedFile::AccessPattern pattern = MappedFile::SEQUENTIAL);
+    size_t size() const { return count; }
+    const PackedPosition &operator[](size_t i) const { return records[i]; }
+    const PackedPosition* begin() const { return records; }
+    const PackedPosition* end() const { return records + count; }
+};
+
+// Writes a game file. The index and footer are written by close()
+class GameWriter {
+private:
+    FILE* file = nullptr;
+    uint64_t offset = 0;
+    std::vector<uint64_t> index;
+
+public:
+    GameWriter() = default;
+    ~GameWriter();
+    GameWriter(const GameWriter&) = delete;
+    GameWriter &operator=(const GameWriter&) = delete;
+
+    bool open(const std::string &path);
+    bool addGame(const Position &start, const Move* moves, int count, GameResult result);
+    // start.result is taken as the result of the game
+    bool addGame(const PackedPosition &start, const Move* moves, int count);
+    bool close();
+    uint64_t written() const { return index.size(); }
+};
+
+// Random access to the games of a game file through its index footer
+class GameReader {
+private:
+    MappedFile file;
+    const uint64_t* index = nullptr;
+    size_t count = 0;
+    uint64_t gameAreaEnd = 0;   // Offset of the index, where the last game has to end
+
+public:
+    // Fails on a missing file, a bad header or footer, or an index pointing outside the game area.
+    // Only the index is read, the games are not touched until game() asks for them
+    bool open(const std::string &path, MappedFile::AccessPattern pattern = MappedFile::RANDOM);
+    size_t size() const { return count; }
+    // False if the record's moves run past the game area, as in a damaged file
+    bool game(size_t i, GameView &view) const;
+};
+
+#endif //EXAMAUTUMN2023_PACKEDFORMAT_H
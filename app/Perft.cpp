@@ -0,0 +1,71 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Perft.h"
+#include "MoveGen.h"
+
+namespace {
+    // Make/unmake on a single position, so a node costs no copies and no allocations
+    uint64_t perftRecursive(Position &pos, int depth) {
+        MoveList moves;
+        generateLegalMoves(pos, moves);
+        if (depth == 1) {
+            return moves.size();
+        }
+        uint64_t nodes = 0;
+        UndoRecord undo;
+        for (auto move : moves) {
+            pos.makeMove(move, undo);
+            nodes += perftRecursive(pos, depth - 1);
+            pos.unmakeMove(move, undo);
+        }
+        return nodes;
+    }
+}
+
+uint64_t perft(const Position &pos, int depth) {
+    if (depth <= 0) {
+        return 1;
+    }
+    Position root = pos;
+    return perftRecursive(root, depth);
+}
+
+uint64_t perftParallel(const Position &pos, int depth, ThreadPool &pool) {
+    if (depth <= 1) {
+        return perft(pos, depth);
+    }
+    MoveList moves;
+    generateLegalMoves(pos, moves);
+
+    // Every task gets its own copy of the position after its root move
+    std::vector<std::future<uint64_t>> results;
+    results.reserve(moves.size());
+    for (auto move : moves) {
+        Position next = pos;
+        UndoRecord undo;
+        next.makeMove(move, undo);
+        results.push_back(pool.submit([next, depth] { return perft(next, depth - 1); }));
+    }
+
+    uint64_t nodes = 0;
+    for (auto &result : results) {
+        nodes += result.get();
+    }
+    return nodes;
+}
+
+std::vector<std::pair<Move, uint64_t>> perftDivide(const Position &pos, int depth) {
+    std::vector<std::pair<Move, uint64_t>> divide;
+    Position root = pos;
+    MoveList moves;
+    generateLegalMoves(root, moves);
+    UndoRecord undo;
+    for (auto move : moves) {
+        root.makeMove(move, undo);
+        divide.emplace_back(move, perft(root, depth - 1));
+        root.unmakeMove(move, undo);
+    }
+    return divide;
+}
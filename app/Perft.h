@@ -0,0 +1,26 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_PERFT_H
+#define EXAMAUTUMN2023_PERFT_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Position.h"
+#include "ThreadPool.h"
+
+/**
+ * Counts the leaf nodes of the legal move tree to the given depth.
+ * The last ply is bulk counted: the size of the move list is the number of leaves.
+ */
+uint64_t perft(const Position &pos, int depth);
+
+// Same count, with each root move searched as its own task on the pool
+uint64_t perftParallel(const Position &pos, int depth, ThreadPool &pool);
+
+// Leaf count below every root move, for comparing against another move generator
+std::vector<std::pair<Move, uint64_t>> perftDivide(const Position &pos, int depth);
+
+#endif //EXAMAUTUMN2023_PERFT_H
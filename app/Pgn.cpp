@@ -0,0 +1,225 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Pgn.h"
+
+namespace {
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    bool isResult(std::string_view token) {
+        return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+    }
+
+    std::string_view trim(std::string_view s) {
+        while (!s.empty() && isSpace(s.front())) s.remove_prefix(1);
+        while (!s.empty() && isSpace(s.back())) s.remove_suffix(1);
+        return s;
+    }
+}
+
+std::string_view PgnGame::tag(std::string_view name) const {
+    for (auto &t : tags) {
+        if (t.name == name) {
+            return t.value;
+        }
+    }
+    return {};
+}
+
+PgnReader::PgnReader(std::string_view text) : text(text) {
+    // Skip a UTF-8 byte order mark
+    if (this->text.substr(0, 3) == "\xEF\xBB\xBF") {
+        offset = 3;
+    }
+}
+
+bool PgnReader::next(PgnGame &game) {
+    game.tags.clear();
+    game.movetext = {};
+    while (offset < text.size() && isSpace(text[offset])) {
+        offset++;
+    }
+    if (offset >= text.size()) {
+        return false;
+    }
+
+    // Tag pair section: [Name "Value"], one per line
+    while (offset < text.size() && text[offset] == '[') {
+        size_t lineEnd = text.find('\n', offset);
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = text.size();
+        }
+        std::string_view line = text.substr(offset, lineEnd - offset);
+        size_t nameEnd = line.find(' ');
+        size_t valueStart = line.find('"');
+        size_t valueEnd = line.rfind('"');
+        if (nameEnd != std::string_view::npos && valueStart != std::string_view::npos && valueEnd > valueStart) {
+            game.tags.push_back({line.substr(1, nameEnd - 1), line.substr(valueStart + 1, valueEnd - valueStart - 1)});
+        }
+        offset = lineEnd;
+        while (offset < text.size() && isSpace(text[offset])) {
+            offset++;
+        }
+    }
+
+    // Movetext runs until a line starting with '[' outside a comment, which opens the next game
+    size_t start = offset;
+    size_t end = text.size();
+    // Inside a comment, the character that ends it: '}' for a brace comment, which does not nest
+    // (the first '}' closes it, as in PgnMoveTokens), or the newline of a ';' rest-of-line comment
+    char commentEnd = 0;
+    for (; offset < text.size(); offset++) {
+        char c = text[offset];
+        if (commentEnd != 0) {
+            if (c != commentEnd) {
+                continue;
+            }
+            commentEnd = 0;
+            if (c == '}') {
+                continue;
+            }
+            // The newline that ends a line comment may still open the next game
+        }
+        if (c == '{') {
+            commentEnd = '}';
+        } else if (c == ';') {
+            commentEnd = '\n';
+        } else if (c == '\n' && offset + 1 < text.size() && text[offset + 1] == '[') {
+            end = offset;
+            offset++;
+            break;
+        }
+    }
+    game.movetext = trim(text.substr(start, end - start));
+    return true;
+}
+
+size_t findGameStart(std::string_view text, size_t from) {
+    if (from == 0 && !text.empty() && text[0] == '[') {
+        return 0;
+    }
+    size_t p = from > 0 ? from - 1 : 0;
+    while ((p = text.find("\n[", p)) != std::string_view::npos) {
+        // Start of the line before this one, skipping leading blanks
+        size_t lineStart = p;
+        while (lineStart > 0 && text[lineStart - 1] != '\n') {
+            lineStart--;
+        }
+        while (lineStart < p && (text[lineStart] == ' ' || text[lineStart] == '\t')) {
+            lineStart++;
+        }
+        if (text[lineStart] != '[') {
+            return p + 1;
+        }
+        p += 2;
+    }
+    return text.size();
+}
+
+bool PgnMoveTokens::next(std::string_view &san) {
+    while (offset < text.size()) {
+        char c = text[offset];
+        if (isSpace(c) || c == ')') {
+            offset++;
+        } else if (c == '{') {
+            size_t close = text.find('}', offset);
+            offset = close == std::string_view::npos ? text.size() : close + 1;
+        } else if (c == ';') {
+            size_t close = text.find('\n', offset);
+            offset = close == std::string_view::npos ? text.size() : close + 1;
+        } else if (c == '(') {
+            // Variations nest, and may contain comments with parentheses in them
+            int depth = 0;
+            for (; offset < text.size(); offset++) {
+                char v = text[offset];
+                if (v == '{') {
+                    size_t close = text.find('}', offset);
+                    offset = close == std::string_view::npos ? text.size() - 1 : close;
+                } else if (v == '(') {
+                    depth++;
+                } else if (v == ')' && --depth == 0) {
+                    offset++;
+                    break;
+                }
+            }
+        } else if (c == '$') {
+            offset++;
+            while (offset < text.size() && isDigit(text[offset])) {
+                offset++;
+            }
+        } else {
+            size_t start = offset;
+            while (offset < text.size() && !isSpace(text[offset]) && text[offset] != '{'
+                   && text[offset] != '(' && text[offset] != ')' && text[offset] != ';') {
+                offset++;
+            }
+            std::string_view token = text.substr(start, offset - start);
+            if (isResult(token)) {
+                resultToken = token;
+                offset = text.size();
+                return false;
+            }
+            // Move numbers, "12." or "12...", possibly glued to the move as in "12.e4"
+            if (isDigit(token.front()) && token.substr(0, 3) != "0-0") {
+                while (!token.empty() && (isDigit(token.front()) || token.front() == '.')) {
+                    token.remove_prefix(1);
+                }
+                if (token.empty()) {
+                    continue;
+                }
+            }
+            san = token;
+            return true;
+        }
+    }
+    return false;
+}
+
+void writePgn(std::string &out, const std::vector<PgnTag> &tags, const Position &start,
+              const std::vector<Move> &moves, std::string_view result) {
+    for (auto &t : tags) {
+        out += '[';
+        out += t.name;
+        out += " \"";
+        out += t.value;
+        out += "\"]\n";
+    }
+    std::string fen = start.toFen();
+    if (fen != START_FEN) {
+        out += "[SetUp \"1\"]\n[FEN \"" + fen + "\"]\n";
+    }
+    out += '\n';
+
+    Position pos = start;
+    UndoRecord undo;
+    size_t lineLength = 0;
+    auto append = [&out, &lineLength](const std::string &token) {
+        if (lineLength > 0 && lineLength + 1 + token.size() >= 80) {
+            out += '\n';
+            lineLength = 0;
+        } else if (lineLength > 0) {
+            out += ' ';
+            lineLength++;
+        }
+        out += token;
+        lineLength += token.size();
+    };
+    for (size_t i = 0; i < moves.size(); i++) {
+        if (pos.sideToMove() == WHITE) {
+            append(std::to_string(pos.fullmoves()) + ".");
+        } else if (i == 0) {
+            append(std::to_string(pos.fullmoves()) + "...");
+        }
+        append(moveToSan(pos, moves[i]));
+        pos.makeMove(moves[i], undo);
+    }
+    append(std::string(result));
+    out += "\n\n";
+}
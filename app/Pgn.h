@@ -0,0 +1,109 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_PGN_H
+#define EXAMAUTUMN2023_PGN_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Move.h"
+#include "Notation.h"
+#include "Position.h"
+
+// One [Name "Value"] pair. Both are views into the PGN text, escapes are left as they are
+struct PgnTag {
+    std::string_view name;
+    std::string_view value;
+};
+
+struct PgnGame {
+    std::vector<PgnTag> tags;
+    std::string_view movetext;
+
+    // Value of the named tag, empty if the game has none
+    std::string_view tag(std::string_view name) const;
+};
+
+/**
+ * Splits PGN text into games without copying it. Every view handed out
+ * points into the text, which must outlive them, typically a MappedFile.
+ */
+class PgnReader {
+private:
+    std::string_view text;
+    size_t offset = 0;
+
+public:
+    explicit PgnReader(std::string_view text);
+
+    // Fills game with the next game. Reusing one PgnGame keeps its tag storage, so this stops allocating
+    bool next(PgnGame &game);
+    size_t bytesRead() const { return offset; }
+    size_t size() const { return text.size(); }
+};
+
+/**
+ * Offset of the first game that starts at or after from, or text.size() if none does.
+ * A game starts at a tag line that does not follow another tag line, which lets
+ * a big file be cut into pieces that each hold whole games.
+ */
+size_t findGameStart(std::string_view text, size_t from);
+
+/**
+ * The SAN tokens of a movetext in order, skipping move numbers, comments,
+ * variations and numeric annotation glyphs. Stops at the game result.
+ */
+class PgnMoveTokens {
+private:
+    std::string_view text;
+    size_t offset = 0;
+    std::string_view resultToken;
+
+public:
+    explicit PgnMoveTokens(std::string_view movetext) : text(movetext) {}
+
+    bool next(std::string_view &san);
+    // "1-0", "0-1", "1/2-1/2" or "*" once next() has reached it, empty before
+    std::string_view result() const { return resultToken; }
+};
+
+/**
+ * Plays game from its start position, the FEN tag if it has one, calling
+ * onMove(pos, move) before each move is made.
+ * @return number of moves played, or -1 if the FEN or a move is invalid.
+ *         pos is then left after the last good move
+ */
+template<class Visitor>
+int replayGame(const PgnGame &game, Position &pos, Visitor &&onMove) {
+    std::string_view fen = game.tag("FEN");
+    if (fen.empty()) {
+        pos.setStartPosition();
+    } else if (!pos.setFromFen(std::string(fen))) {
+        return -1;
+    }
+    PgnMoveTokens tokens(game.movetext);
+    std::string_view san;
+    UndoRecord undo;
+    int count = 0;
+    while (tokens.next(san)) {
+        Move m = parseSan(pos, san);
+        if (m == NO_MOVE) {
+            return -1;
+        }
+        onMove(pos, m);
+        pos.makeMove(m, undo);
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Appends one game in export format: the given tags, a FEN tag if start is not
+ * the initial position, then the SAN movetext wrapped below 80 columns and the result.
+ */
+void writePgn(std::string &out, const std::vector<PgnTag> &tags, const Position &start,
+              const std::vector<Move> &moves, std::string_view result);
+
+#endif //EXAMAUTUMN2023_PGN_H
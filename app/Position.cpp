@@ -0,0 +1,403 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Position.h"
+#include "Attacks.h"
+#include "Psqt.h"
+#include "Zobrist.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+    // Castling rights lost when a move starts or ends on sq
+    int castlingRightsTouched(int sq) {
+        switch (sq) {
+            case 0:  return WHITE_OOO;
+            case 4:  return WHITE_OO | WHITE_OOO;
+            case 7:  return WHITE_OO;
+            case 56: return BLACK_OOO;
+            case 60: return BLACK_OO | BLACK_OOO;
+            case 63: return BLACK_OO;
+            default: return 0;
+        }
+    }
+}
+
+Position::Position() {
+    Attacks::init();
+    Zobrist::init();
+    Psqt::init();
+    clear();
+}
+
+void Position::clear() {
+    for (auto &bb : pieceBB) {
+        bb = 0;
+    }
+    colorBB[WHITE] = 0;
+    colorBB[BLACK] = 0;
+    occupiedBB = 0;
+    for (auto &square : mailbox) {
+        square = NO_PIECE;
+    }
+    side = WHITE;
+    castling = 0;
+    epSquare = NO_SQUARE;
+    halfmoveClock = 0;
+    fullmoveNumber = 1;
+    key = 0;
+    pawnHashKey = 0;
+    psqMg = 0;
+    psqEg = 0;
+    phase = 0;
+}
+
+void Position::setStartPosition() {
+    clear();
+    const ChessPieceType backRank[8] = {ROOK, KNIGHT, BISHOP, QUEEN, KING, BISHOP, KNIGHT, ROOK};
+    for (int file = 0; file < 8; file++) {
+        putPiece(makePiece(backRank[file], WHITE), file);
+        putPiece(makePiece(PAWN, WHITE), 8 + file);
+        putPiece(makePiece(PAWN, BLACK), 48 + file);
+        putPiece(makePiece(backRank[file], BLACK), 56 + file);
+    }
+    castling = WHITE_OO | WHITE_OOO | BLACK_OO | BLACK_OOO;
+    key = computeKey();
+}
+
+bool Position::setFromFen(const std::string &fen) {
+    clear();
+    std::istringstream stream(fen);
+    std::string board, sideField, castlingField, epField;
+    stream >> board >> sideField >> castlingField >> epField;
+    if (board.empty() || (sideField != "w" && sideField != "b")) {
+        clear();
+        return false;
+    }
+
+    // Board, rank 8 first
+    const std::string pieceChars = "PRNBQK";
+    int file = 0;
+    int rank = 7;
+    for (char c : board) {
+        if (c == '/') {
+            file = 0;
+            rank--;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+        } else {
+            auto type = pieceChars.find((char) toupper(c));
+            if (type == std::string::npos || file > 7 || rank < 0) {
+                clear();
+                return false;
+            }
+            putPiece(makePiece((ChessPieceType) type, isupper(c) ? WHITE : BLACK), rank * 8 + file);
+            file++;
+        }
+    }
+    if (popCount(pieces(WHITE, KING)) != 1 || popCount(pieces(BLACK, KING)) != 1) {
+        clear();
+        return false;
+    }
+
+    int castlingRights = 0;
+    for (char c : castlingField) {
+        switch (c) {
+            case 'K': castlingRights |= WHITE_OO; break;
+            case 'Q': castlingRights |= WHITE_OOO; break;
+            case 'k': castlingRights |= BLACK_OO; break;
+            case 'q': castlingRights |= BLACK_OOO; break;
+            default: break;
+        }
+    }
+    int ep = NO_SQUARE;
+    if (epField.size() == 2 && epField[0] >= 'a' && epField[0] <= 'h' && (epField[1] == '3' || epField[1] == '6')) {
+        ep = (epField[1] - '1') * 8 + (epField[0] - 'a');
+    }
+    int halfmove = 0;
+    int fullmove = 1;
+    if (!(stream >> halfmove >> fullmove)) {
+        halfmove = 0;
+        fullmove = 1;
+    }
+    setState(sideField == "w" ? WHITE : BLACK, castlingRights, ep, halfmove, fullmove);
+    return true;
+}
+
+void Position::setState(Color sideToMove, int castlingRights, int ep, int halfmoves, int fullmoves) {
+    side = sideToMove;
+    castling = (uint8_t) (castlingRights & (WHITE_OO | WHITE_OOO | BLACK_OO | BLACK_OOO));
+    // Drop rights the pieces on the board cannot back up
+    if (pieceOn(4) != makePiece(KING, WHITE)) castling &= ~(WHITE_OO | WHITE_OOO);
+    if (pieceOn(7) != makePiece(ROOK, WHITE)) castling &= ~WHITE_OO;
+    if (pieceOn(0) != makePiece(ROOK, WHITE)) castling &= ~WHITE_OOO;
+    if (pieceOn(60) != makePiece(KING, BLACK)) castling &= ~(BLACK_OO | BLACK_OOO);
+    if (pieceOn(63) != makePiece(ROOK, BLACK)) castling &= ~BLACK_OO;
+    if (pieceOn(56) != makePiece(ROOK, BLACK)) castling &= ~BLACK_OOO;
+
+    // Same rule as makeMove: keep the en passant square only if a pawn can capture there
+    epSquare = NO_SQUARE;
+    if (ep >= 0 && ep < 64 && (rankOf(ep) == (side == WHITE ? 5 : 2))
+        && (Attacks::pawn(~side, ep) & pieces(side, PAWN))) {
+        epSquare = (uint8_t) ep;
+    }
+
+    halfmoveClock = halfmoves;
+    fullmoveNumber = fullmoves > 0 ? fullmoves : 1;
+    key = computeKey();
+}
+
+std::string Position::toFen() const {
+    const char pieceChars[12] = {'P', 'R', 'N', 'B', 'Q', 'K', 'p', 'r', 'n', 'b', 'q', 'k'};
+    std::string fen;
+    for (int rank = 7; rank >= 0; rank--) {
+        int empty = 0;
+        for (int file = 0; file < 8; file++) {
+            int piece = pieceOn(rank * 8 + file);
+            if (piece == NO_PIECE) {
+                empty++;
+                continue;
+            }
+            if (empty) {
+                fen += (char) ('0' + empty);
+                empty = 0;
+            }
+            fen += pieceChars[piece];
+        }
+        if (empty) {
+            fen += (char) ('0' + empty);
+        }
+        if (rank > 0) {
+            fen += '/';
+        }
+    }
+
+    fen += side == WHITE ? " w " : " b ";
+    if (castling & WHITE_OO) fen += 'K';
+    if (castling & WHITE_OOO) fen += 'Q';
+    if (castling & BLACK_OO) fen += 'k';
+    if (castling & BLACK_OOO) fen += 'q';
+    if (!castling) fen += '-';
+
+    if (epSquare != NO_SQUARE) {
+        fen += ' ';
+        fen += (char) ('a' + fileOf(epSquare));
+        fen += (char) ('1' + rankOf(epSquare));
+    } else {
+        fen += " -";
+    }
+    fen += ' ' + std::to_string(halfmoveClock) + ' ' + std::to_string(fullmoveNumber);
+    return fen;
+}
+
+void Position::putPiece(int piece, int sq) {
+    Bitboard bb = squareBB(sq);
+    pieceBB[piece] |= bb;
+    colorBB[colorOf(piece)] |= bb;
+    occupiedBB |= bb;
+    mailbox[sq] = (uint8_t) piece;
+    key ^= Zobrist::PieceKeys[piece][sq];
+    if (typeOf(piece) == PAWN) {
+        pawnHashKey ^= Zobrist::PieceKeys[piece][sq];
+    }
+    psqMg += Psqt::Mg[piece][sq];
+    psqEg += Psqt::Eg[piece][sq];
+    phase += Psqt::PHASE_WEIGHTS[typeOf(piece)];
+}
+
+void Position::removePiece(int sq) {
+    int piece = mailbox[sq];
+    if (piece == NO_PIECE) {
+        return;
+    }
+    Bitboard bb = squareBB(sq);
+    pieceBB[piece] ^= bb;
+    colorBB[colorOf(piece)] ^= bb;
+    occupiedBB ^= bb;
+    mailbox[sq] = NO_PIECE;
+    key ^= Zobrist::PieceKeys[piece][sq];
+    if (typeOf(piece) == PAWN) {
+        pawnHashKey ^= Zobrist::PieceKeys[piece][sq];
+    }
+    psqMg -= Psqt::Mg[piece][sq];
+    psqEg -= Psqt::Eg[piece][sq];
+    phase -= Psqt::PHASE_WEIGHTS[typeOf(piece)];
+}
+
+// Moves whatever stands on from to the empty square to
+void Position::movePiece(int from, int to) {
+    int piece = mailbox[from];
+    Bitboard fromTo = squareBB(from) | squareBB(to);
+    pieceBB[piece] ^= fromTo;
+    colorBB[colorOf(piece)] ^= fromTo;
+    occupiedBB ^= fromTo;
+    mailbox[from] = NO_PIECE;
+    mailbox[to] = (uint8_t) piece;
+    key ^= Zobrist::PieceKeys[piece][from] ^ Zobrist::PieceKeys[piece][to];
+    if (typeOf(piece) == PAWN) {
+        pawnHashKey ^= Zobrist::PieceKeys[piece][from] ^ Zobrist::PieceKeys[piece][to];
+    }
+    psqMg += Psqt::Mg[piece][to] - Psqt::Mg[piece][from];
+    psqEg += Psqt::Eg[piece][to] - Psqt::Eg[piece][from];
+}
+
+uint64_t Position::computeKey() const {
+    uint64_t k = 0;
+    for (int sq = 0; sq < 64; sq++) {
+        if (mailbox[sq] != NO_PIECE) {
+            k ^= Zobrist::PieceKeys[mailbox[sq]][sq];
+        }
+    }
+    k ^= Zobrist::CastlingKeys[castling];
+    if (epSquare != NO_SQUARE) {
+        k ^= Zobrist::EnPassantKeys[fileOf(epSquare)];
+    }
+    if (side == BLACK) {
+        k ^= Zobrist::SideKey;
+    }
+    return k;
+}
+
+// Debug builds (CHESS_DEBUG_HASH) compare the incremental key with a full recompute after every move
+void Position::verifyKey() const {
+#if defined(CHESS_DEBUG_HASH)
+    if (key != computeKey()) {
+        fprintf(stderr, "Zobrist key mismatch: incremental %016llx, computed %016llx\n",
+                (unsigned long long) key, (unsigned long long) computeKey());
+        abort();
+    }
+#endif
+}
+
+Bitboard Position::attackersTo(int sq, Bitboard occupied) const {
+    Bitboard rooksQueens = pieceBB[makePiece(ROOK, WHITE)] | pieceBB[makePiece(ROOK, BLACK)]
+                         | pieceBB[makePiece(QUEEN, WHITE)] | pieceBB[makePiece(QUEEN, BLACK)];
+    Bitboard bishopsQueens = pieceBB[makePiece(BISHOP, WHITE)] | pieceBB[makePiece(BISHOP, BLACK)]
+                           | pieceBB[makePiece(QUEEN, WHITE)] | pieceBB[makePiece(QUEEN, BLACK)];
+    return (Attacks::pawn(WHITE, sq) & pieceBB[makePiece(PAWN, BLACK)])
+         | (Attacks::pawn(BLACK, sq) & pieceBB[makePiece(PAWN, WHITE)])
+         | (Attacks::knight(sq) & (pieceBB[makePiece(KNIGHT, WHITE)] | pieceBB[makePiece(KNIGHT, BLACK)]))
+         | (Attacks::king(sq) & (pieceBB[makePiece(KING, WHITE)] | pieceBB[makePiece(KING, BLACK)]))
+         | (Attacks::rook(sq, occupied) & rooksQueens)
+         | (Attacks::bishop(sq, occupied) & bishopsQueens);
+}
+
+Bitboard Position::checkers() const {
+    return attackersTo(kingSquare(side), occupiedBB) & colorBB[~side];
+}
+
+void Position::makeMove(Move m, UndoRecord &undo) {
+    int from = moveFrom(m);
+    int to = moveTo(m);
+    int flags = moveFlags(m);
+    Color us = side;
+
+    undo.key = key;
+    undo.captured = NO_PIECE;
+    undo.castling = castling;
+    undo.epSquare = epSquare;
+    undo.halfmoveClock = (uint16_t) halfmoveClock;
+
+    halfmoveClock++;
+    if (typeOf(mailbox[from]) == PAWN || isCapture(m)) {
+        halfmoveClock = 0;
+    }
+
+    if (isCapture(m)) {
+        int capturedSq = flags == EP_CAPTURE ? (us == WHITE ? to - 8 : to + 8) : to;
+        undo.captured = mailbox[capturedSq];
+        removePiece(capturedSq);
+    }
+    movePiece(from, to);
+
+    if (isPromotion(m)) {
+        removePiece(to);
+        putPiece(makePiece(promotionType(m), us), to);
+    } else if (flags == KING_CASTLE) {
+        movePiece(to + 1, to - 1);
+    } else if (flags == QUEEN_CASTLE) {
+        movePiece(to - 2, to + 1);
+    }
+
+    // Only remember the en passant square if an enemy pawn can actually use it
+    if (epSquare != NO_SQUARE) {
+        key ^= Zobrist::EnPassantKeys[fileOf(epSquare)];
+    }
+    epSquare = NO_SQUARE;
+    if (flags == DOUBLE_PUSH) {
+        int passed = (from + to) / 2;
+        if (Attacks::pawn(us, passed) & pieces(~us, PAWN)) {
+            epSquare = (uint8_t) passed;
+            key ^= Zobrist::EnPassantKeys[fileOf(passed)];
+        }
+    }
+
+    key ^= Zobrist::CastlingKeys[castling];
+    castling &= ~(castlingRightsTouched(from) | castlingRightsTouched(to));
+    key ^= Zobrist::CastlingKeys[castling];
+
+    if (us == BLACK) {
+        fullmoveNumber++;
+    }
+    side = ~us;
+    key ^= Zobrist::SideKey;
+    verifyKey();
+}
+
+void Position::unmakeMove(Move m, const UndoRecord &undo) {
+    int from = moveFrom(m);
+    int to = moveTo(m);
+    int flags = moveFlags(m);
+    side = ~side;
+    Color us = side;
+
+    if (isPromotion(m)) {
+        removePiece(to);
+        putPiece(makePiece(PAWN, us), to);
+    } else if (flags == KING_CASTLE) {
+        movePiece(to - 1, to + 1);
+    } else if (flags == QUEEN_CASTLE) {
+        movePiece(to + 1, to - 2);
+    }
+    movePiece(to, from);
+
+    if (undo.captured != NO_PIECE) {
+        int capturedSq = flags == EP_CAPTURE ? (us == WHITE ? to - 8 : to + 8) : to;
+        putPiece(undo.captured, capturedSq);
+    }
+
+    castling = undo.castling;
+    epSquare = undo.epSquare;
+    halfmoveClock = undo.halfmoveClock;
+    key = undo.key;
+    if (us == BLACK) {
+        fullmoveNumber--;
+    }
+    verifyKey();
+}
+
+void Position::makeNullMove(UndoRecord &undo) {
+    undo.key = key;
+    undo.captured = NO_PIECE;
+    undo.castling = castling;
+    undo.epSquare = epSquare;
+    undo.halfmoveClock = (uint16_t) halfmoveClock;
+
+    if (epSquare != NO_SQUARE) {
+        key ^= Zobrist::EnPassantKeys[fileOf(epSquare)];
+        epSquare = NO_SQUARE;
+    }
+    halfmoveClock++;
+    side = ~side;
+    key ^= Zobrist::SideKey;
+}
+
+void Position::unmakeNullMove(const UndoRecord &undo) {
+    side = ~side;
+    epSquare = undo.epSquare;
+    halfmoveClock = undo.halfmoveClock;
+    key = undo.key;
+}
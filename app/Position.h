@@ -0,0 +1,185 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_POSITION_H
+#define EXAMAUTUMN2023_POSITION_H
+
+#include <cstdint>
+#include <string>
+#include "Bitboard.h"
+#include "ChessPiece.h"
+#include "Move.h"
+#include "Psqt.h"
+
+enum Color {
+    WHITE,
+    BLACK
+};
+
+constexpr const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Pieces are encoded as type + 6 * color, so white pieces are 0-5 and black pieces 6-11
+constexpr int NO_PIECE = 12;
+
+constexpr int makePiece(ChessPieceType type, Color color) {
+    return type + 6 * color;
+}
+
+constexpr ChessPieceType typeOf(int piece) {
+    return (ChessPieceType) (piece % 6);
+}
+
+constexpr Color colorOf(int piece) {
+    return piece < 6 ? WHITE : BLACK;
+}
+
+constexpr Color operator~(Color c) {
+    return (Color) (c ^ 1);
+}
+
+constexpr int NO_SQUARE = 64;
+
+enum CastlingRight {
+    WHITE_OO = 1,
+    WHITE_OOO = 2,
+    BLACK_OO = 4,
+    BLACK_OOO = 8
+};
+
+/**
+ * Everything makeMove overwrites that cannot be recomputed from the move itself.
+ * Plain old data, so undo stacks are just arrays of these.
+ */
+struct UndoRecord {
+    uint64_t key;           // Zobrist key before the move
+    uint8_t captured;       // Piece removed by the move, NO_PIECE if none
+    uint8_t castling;
+    uint8_t epSquare;
+    uint16_t halfmoveClock;
+};
+
+/**
+ * Compact board representation: one bitboard per piece (12), one per color,
+ * the total occupancy and a square -> piece mailbox for O(1) lookups.
+ * The class has no heap members and can be copied with a plain memcpy.
+ */
+class Position {
+private:
+    Bitboard pieceBB[12];
+    Bitboard colorBB[2];
+    Bitboard occupiedBB;
+    uint8_t mailbox[64];
+    Color side;
+    uint8_t castling;       // CastlingRight bits
+    uint8_t epSquare;       // Square a pawn can capture en passant on, NO_SQUARE if none
+    int halfmoveClock;
+    int fullmoveNumber;
+    uint64_t key;           // Zobrist key, kept up to date by every change to the position
+    uint64_t pawnHashKey;   // Zobrist key of the pawns alone, for the pawn structure cache
+    int psqMg;              // Sum of Psqt::Mg over all pieces, material included
+    int psqEg;
+    int phase;              // Sum of Psqt::PHASE_WEIGHTS, may exceed PHASE_MAX after promotions
+    void verifyKey() const;
+public:
+    Position();
+    void clear();
+    void setStartPosition();
+    // Loads a position in Forsyth-Edwards Notation. Returns false and leaves an empty board if it is invalid
+    bool setFromFen(const std::string &fen);
+    // The position in Forsyth-Edwards Notation, readable by setFromFen
+    std::string toFen() const;
+    /**
+     * Sets everything but the pieces, after they have been placed with putPiece.
+     * Castling rights and the en passant square are dropped where the board
+     * cannot back them up, the key is recomputed
+     */
+    void setState(Color sideToMove, int castlingRights, int ep, int halfmoves, int fullmoves);
+
+    void putPiece(int piece, int sq);
+    void removePiece(int sq);
+    void movePiece(int from, int to);
+
+    int pieceOn(int sq) const { return mailbox[sq]; }
+    bool isEmpty(int sq) const { return mailbox[sq] == NO_PIECE; }
+    Bitboard pieces(int piece) const { return pieceBB[piece]; }
+    Bitboard pieces(Color color, ChessPieceType type) const { return pieceBB[makePiece(type, color)]; }
+    Bitboard pieces(Color color) const { return colorBB[color]; }
+    Bitboard occupied() const { return occupiedBB; }
+
+    Color sideToMove() const { return side; }
+    int castlingRights() const { return castling; }
+    int enPassantSquare() const { return epSquare; }
+    int halfmoves() const { return halfmoveClock; }
+    int fullmoves() const { return fullmoveNumber; }
+    int kingSquare(Color color) const { return lsb(pieces(color, KING)); }
+
+    uint64_t hash() const { return key; }
+    uint64_t pawnKey() const { return pawnHashKey; }
+    // Material and piece-square score from white's point of view, kept up to date incrementally
+    int mgScore() const { return psqMg; }
+    int egScore() const { return psqEg; }
+    int gamePhase() const { return phase < Psqt::PHASE_MAX ? phase : Psqt::PHASE_MAX; }
+    // Zobrist key computed from scratch, the incremental key must always equal this
+    uint64_t computeKey() const;
+
+    // Pieces of both colors attacking sq, given the occupancy occupied
+    Bitboard attackersTo(int sq, Bitboard occupied) const;
+    // Pieces giving check to the side to move
+    Bitboard checkers() const;
+    bool inCheck() const { return checkers() != 0; }
+
+    // Plays a legal move for the side to move and saves what unmakeMove needs in undo
+    void makeMove(Move m, UndoRecord &undo);
+    // Takes back m, which must be the last move made, using the record makeMove filled
+    void unmakeMove(Move m, const UndoRecord &undo);
+    // Passes the turn without moving, used by null-move pruning. Not legal when in check
+    void makeNullMove(UndoRecord &undo);
+    void unmakeNullMove(const UndoRecord &undo);
+};
+
+/**
+ * Moves played from some root position together with their undo records.
+ * Capacity is fixed, so pushing a move never allocates. 1024 plies covers
+ * any game plus a search line on top of it.
+ */
+class MoveHistory {
+private:
+    static constexpr int CAPACITY = 1024;
+    Move moves[CAPACITY];
+    UndoRecord records[CAPACITY];
+    int count = 0;
+public:
+    void push(Position &pos, Move m) {
+        moves[count] = m;
+        pos.makeMove(m, records[count]);
+        count++;
+    }
+    void pop(Position &pos) {
+        count--;
+        pos.unmakeMove(moves[count], records[count]);
+    }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool full() const { return count == CAPACITY; }
+    Move move(int i) const { return moves[i]; }
+    Move lastMove() const { return count ? moves[count - 1] : NO_MOVE; }
+    // Zobrist key of the position before move i
+    uint64_t key(int i) const { return records[i].key; }
+
+    // How many earlier positions in the history equal pos. Only positions since the
+    // last capture or pawn move can repeat, and only those with the same side to move
+    int repetitions(const Position &pos) const {
+        int found = 0;
+        int oldest = count - pos.halfmoves();
+        for (int i = count - 2; i >= 0 && i >= oldest; i -= 2) {
+            if (records[i].key == pos.hash()) {
+                found++;
+            }
+        }
+        return found;
+    }
+};
+
+
+#endif //EXAMAUTUMN2023_POSITION_H
@@ -0,0 +1,123 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Psqt.h"
+#include "Position.h"
+
+int Psqt::Mg[12][64];
+int Psqt::Eg[12][64];
+
+namespace {
+    // Indexed by ChessPieceType: pawn, rook, knight, bishop, queen, king
+    constexpr int MG_VALUES[6] = {100, 500, 320, 330, 900, 0};
+    constexpr int EG_VALUES[6] = {120, 530, 300, 320, 950, 0};
+
+    // Tables are written as the board is seen from white's side: a8 first, h1 last
+    constexpr int PAWN_MG[64] = {
+              0,   0,   0,   0,   0,   0,   0,   0,
+             50,  50,  50,  50,  50,  50,  50,  50,
+             10,  10,  20,  30,  30,  20,  10,  10,
+              5,   5,  10,  25,  25,  10,   5,   5,
+              0,   0,   0,  20,  20,   0,   0,   0,
+              5,  -5, -10,   0,   0, -10,  -5,   5,
+              5,  10,  10, -20, -20,  10,  10,   5,
+              0,   0,   0,   0,   0,   0,   0,   0,
+    };
+    // In the endgame every step forward counts, passed pawns get more from the evaluation
+    constexpr int PAWN_EG[64] = {
+              0,   0,   0,   0,   0,   0,   0,   0,
+             50,  50,  50,  50,  50,  50,  50,  50,
+             30,  30,  30,  30,  30,  30,  30,  30,
+             15,  15,  15,  15,  15,  15,  15,  15,
+              5,   5,   5,   5,   5,   5,   5,   5,
+              0,   0,   0,   0,   0,   0,   0,   0,
+              0,   0,   0,   0,   0,   0,   0,   0,
+              0,   0,   0,   0,   0,   0,   0,   0,
+    };
+    constexpr int KNIGHT_PSQ[64] = {
+            -50, -40, -30, -30, -30, -30, -40, -50,
+            -40, -20,   0,   0,   0,   0, -20, -40,
+            -30,   0,  10,  15,  15,  10,   0, -30,
+            -30,   5,  15,  20,  20,  15,   5, -30,
+            -30,   0,  15,  20,  20,  15,   0, -30,
+            -30,   5,  10,  15,  15,  10,   5, -30,
+            -40, -20,   0,   5,   5,   0, -20, -40,
+            -50, -40, -30, -30, -30, -30, -40, -50,
+    };
+    constexpr int BISHOP_PSQ[64] = {
+            -20, -10, -10, -10, -10, -10, -10, -20,
+            -10,   0,   0,   0,   0,   0,   0, -10,
+            -10,   0,   5,  10,  10,   5,   0, -10,
+            -10,   5,   5,  10,  10,   5,   5, -10,
+            -10,   0,  10,  10,  10,  10,   0, -10,
+            -10,  10,  10,  10,  10,  10,  10, -10,
+            -10,   5,   0,   0,   0,   0,   5, -10,
+            -20, -10, -10, -10, -10, -10, -10, -20,
+    };
+    constexpr int ROOK_PSQ[64] = {
+              0,   0,   0,   0,   0,   0,   0,   0,
+              5,  10,  10,  10,  10,  10,  10,   5,
+             -5,   0,   0,   0,   0,   0,   0,  -5,
+             -5,   0,   0,   0,   0,   0,   0,  -5,
+             -5,   0,   0,   0,   0,   0,   0,  -5,
+             -5,   0,   0,   0,   0,   0,   0,  -5,
+             -5,   0,   0,   0,   0,   0,   0,  -5,
+              0,   0,   0,   5,   5,   0,   0,   0,
+    };
+    constexpr int QUEEN_PSQ[64] = {
+            -20, -10, -10,  -5,  -5, -10, -10, -20,
+            -10,   0,   0,   0,   0,   0,   0, -10,
+            -10,   0,   5,   5,   5,   5,   0, -10,
+             -5,   0,   5,   5,   5,   5,   0,  -5,
+              0,   0,   5,   5,   5,   5,   0,  -5,
+            -10,   5,   5,   5,   5,   5,   0, -10,
+            -10,   0,   5,   0,   0,   0,   0, -10,
+            -20, -10, -10,  -5,  -5, -10, -10, -20,
+    };
+    // Tucked away behind its pawns while there are pieces to attack it...
+    constexpr int KING_MG[64] = {
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -20, -30, -30, -40, -40, -30, -30, -20,
+            -10, -20, -20, -20, -20, -20, -20, -10,
+             20,  20,   0,   0,   0,   0,  20,  20,
+             20,  30,  10,   0,   0,  10,  30,  20,
+    };
+    // ...and in the centre once they are gone
+    constexpr int KING_EG[64] = {
+            -50, -40, -30, -20, -20, -30, -40, -50,
+            -30, -20, -10,   0,   0, -10, -20, -30,
+            -30, -10,  20,  30,  30,  20, -10, -30,
+            -30, -10,  30,  40,  40,  30, -10, -30,
+            -30, -10,  30,  40,  40,  30, -10, -30,
+            -30, -10,  20,  30,  30,  20, -10, -30,
+            -30, -30,   0,   0,   0,   0, -30, -30,
+            -50, -30, -30, -30, -30, -30, -30, -50,
+    };
+
+    const int* const MG_TABLES[6] = {PAWN_MG, ROOK_PSQ, KNIGHT_PSQ, BISHOP_PSQ, QUEEN_PSQ, KING_MG};
+    const int* const EG_TABLES[6] = {PAWN_EG, ROOK_PSQ, KNIGHT_PSQ, BISHOP_PSQ, QUEEN_PSQ, KING_EG};
+
+    void fillTables() {
+        for (int type = PAWN; type <= KING; type++) {
+            for (int sq = 0; sq < 64; sq++) {
+                // sq ^ 56 flips the rank: a white piece on sq reads row 7 - rank of the table,
+                // a black piece on sq is the mirror image of a white piece on sq ^ 56
+                int white = makePiece((ChessPieceType) type, WHITE);
+                int black = makePiece((ChessPieceType) type, BLACK);
+                Psqt::Mg[white][sq] = MG_VALUES[type] + MG_TABLES[type][sq ^ 56];
+                Psqt::Eg[white][sq] = EG_VALUES[type] + EG_TABLES[type][sq ^ 56];
+                Psqt::Mg[black][sq] = -(MG_VALUES[type] + MG_TABLES[type][sq]);
+                Psqt::Eg[black][sq] = -(EG_VALUES[type] + EG_TABLES[type][sq]);
+            }
+        }
+    }
+}
+
+void Psqt::init() {
+    static const bool initialized = (fillTables(), true);
+    (void) initialized;
+}
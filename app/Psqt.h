@@ -0,0 +1,27 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_PSQT_H
+#define EXAMAUTUMN2023_PSQT_H
+
+/**
+ * Piece-square tables with the material value folded in, one for the middlegame
+ * and one for the endgame. Entries are from white's point of view, so black
+ * pieces have negative values and a position's score is the plain sum over its
+ * pieces. Position keeps that sum up to date on every piece change.
+ * init() must be called before the tables are used; Position's constructor does it.
+ */
+namespace Psqt {
+    extern int Mg[12][64];
+    extern int Eg[12][64];
+
+    // Game phase: 24 with all pieces on the board, 0 with only kings and pawns left
+    constexpr int PHASE_MAX = 24;
+    // Phase units per piece, indexed by ChessPieceType
+    constexpr int PHASE_WEIGHTS[6] = {0, 2, 1, 1, 4, 0};
+
+    void init();
+}
+
+#endif //EXAMAUTUMN2023_PSQT_H
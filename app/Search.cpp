@@ -0,0 +1,628 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Search.h"
+#include "Evaluation.h"
+#include "MoveGen.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace {
+    // Late-move reduction in plies, indexed by remaining depth and move number
+    int Reductions[64][64];
+
+    void initReductions() {
+        for (int depth = 1; depth < 64; depth++) {
+            for (int moveNumber = 1; moveNumber < 64; moveNumber++) {
+                Reductions[depth][moveNumber] = (int) (0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+            }
+        }
+    }
+
+    // Mate scores are stored relative to the node so they stay valid at other plies
+    int scoreToTT(int score, int ply) {
+        if (score >= VALUE_MATE_IN_MAX_PLY) return score + ply;
+        if (score <= -VALUE_MATE_IN_MAX_PLY) return score - ply;
+        return score;
+    }
+
+    int scoreFromTT(int score, int ply) {
+        if (score >= VALUE_MATE_IN_MAX_PLY) return score - ply;
+        if (score <= -VALUE_MATE_IN_MAX_PLY) return score + ply;
+        return score;
+    }
+
+    int capturedValue(const Position &pos, Move m) {
+        if (moveFlags(m) == EP_CAPTURE) {
+            return PIECE_VALUES[PAWN];
+        }
+        return isCapture(m) ? PIECE_VALUES[typeOf(pos.pieceOn(moveTo(m)))] : 0;
+    }
+
+    // Moves the best scored move left in [i, count) to position i
+    void pickNext(MoveList &moves, int scores[], int i) {
+        int best = i;
+        for (int j = i + 1; j < moves.count; j++) {
+            if (scores[j] > scores[best]) {
+                best = j;
+            }
+        }
+        std::swap(moves.moves[i], moves.moves[best]);
+        std::swap(scores[i], scores[best]);
+    }
+
+    // History "gravity": large values grow slower, so the table stays within +-16384
+    void updateHistory(int &entry, int bonus) {
+        entry += bonus - entry * std::abs(bonus) / 16384;
+    }
+
+    constexpr int TT_MOVE_SCORE = 1 << 30;
+    constexpr int CAPTURE_SCORE = 1 << 20;
+}
+
+Search::Search(TranspositionTable &tt, unsigned threadCount) : tt(tt) {
+    static const bool reductionsReady = (initReductions(), true);
+    (void) reductionsReady;
+    setThreads(threadCount);
+}
+
+void Search::setThreads(unsigned threadCount) {
+    threadCount = std::max(1u, threadCount);
+    helpers.reset();
+    threads.clear();
+    for (unsigned i = 0; i < threadCount; i++) {
+        auto t = std::make_unique<ThreadData>();
+        t->id = (int) i;
+        memset(t->history, 0, sizeof(t->history));
+        threads.push_back(std::move(t));
+    }
+    // The calling thread searches as thread 0, the pool runs the helpers
+    if (threadCount > 1) {
+        helpers = std::make_unique<ThreadPool>(threadCount - 1);
+    }
+}
+
+uint64_t Search::totalNodes() const {
+    uint64_t nodes = 0;
+    for (auto &t : threads) {
+        nodes += t->nodes.load(std::memory_order_relaxed);
+    }
+    return nodes;
+}
+
+uint64_t Search::totalTbHits() const {
+    uint64_t hits = 0;
+    for (auto &t : threads) {
+        hits += t->tbHits.load(std::memory_order_relaxed);
+    }
+    return hits;
+}
+
+int64_t Search::elapsedMs() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime).count();
+}
+
+void Search::setTimeLimits(Color us) {
+    softLimitMs = 0;
+    hardLimitMs = 0;
+    if (limits.infinite) {
+        return;
+    }
+    if (limits.moveTime > 0) {
+        softLimitMs = limits.moveTime;
+        hardLimitMs = limits.moveTime;
+        return;
+    }
+    if (limits.time[us] > 0) {
+        // Spread the clock over the moves left, keeping a little back for communication overhead
+        int64_t available = std::max<int64_t>(1, limits.time[us] - 30);
+        int movesToGo = limits.movesToGo > 0 ? std::min(limits.movesToGo, 50) : 30;
+        softLimitMs = std::min(available / movesToGo + limits.increment[us] * 3 / 4, available / 2);
+        softLimitMs = std::max<int64_t>(1, softLimitMs);
+        hardLimitMs = std::max(softLimitMs, std::min(softLimitMs * 4, available * 3 / 4));
+    }
+}
+
+void Search::checkLimits(const ThreadData &t) {
+    // Helpers just follow the main thread's stop flag
+    if (t.id != 0 || (t.nodes.load(std::memory_order_relaxed) & 1023)) {
+        return;
+    }
+    if ((limits.nodes && totalNodes() >= limits.nodes)
+        || (hardLimitMs && !pondering.load(std::memory_order_relaxed) && elapsedMs() >= hardLimitMs)) {
+        stopRequested = true;
+    }
+}
+
+bool Search::isDraw(const ThreadData &t) const {
+    // The fifty-move rule, unless the hundredth half-move gave mate: checkmate takes precedence
+    if (t.pos.halfmoves() >= 100) {
+        if (!t.pos.inCheck()) {
+            return true;
+        }
+        MoveList legal;
+        generateLegalMoves(t.pos, legal);
+        return legal.size() > 0;
+    }
+    // Any repetition inside the game or the search line is scored as a draw
+    int oldest = std::max(0, t.keyCount - 1 - t.pos.halfmoves());
+    for (int i = t.keyCount - 3; i >= oldest; i -= 2) {
+        if (t.keys[i] == t.pos.hash()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int Search::staticEvaluation(ThreadData &t, int ply) const {
+    return network ? network->evaluate(t.accumulators[ply], t.pos.sideToMove()) : evaluate(t.pos, &t.pawns);
+}
+
+void Search::makeMove(ThreadData &t, Move m, int ply) {
+    t.pos.makeMove(m, t.undo[ply]);
+    if (network) {
+        network->update(t.accumulators[ply], t.accumulators[ply + 1], t.pos, m, t.undo[ply]);
+    }
+    t.keys[t.keyCount++] = t.pos.hash();
+    tt.prefetch(t.pos.hash());
+}
+
+void Search::unmakeMove(ThreadData &t, Move m, int ply) {
+    t.keyCount--;
+    t.pos.unmakeMove(m, t.undo[ply]);
+}
+
+void Search::scoreMoves(const ThreadData &t, const MoveList &moves, int scores[], Move ttMove, int ply) const {
+    Color us = t.pos.sideToMove();
+    for (int i = 0; i < moves.count; i++) {
+        Move m = moves.moves[i];
+        if (m == ttMove) {
+            scores[i] = TT_MOVE_SCORE;
+        } else if (isCapture(m) || isPromotion(m)) {
+            // Most valuable victim first, least valuable attacker as tie-break. Captures that
+            // lose material in the exchange go after the quiet moves
+            int attacker = PIECE_VALUES[typeOf(t.pos.pieceOn(moveFrom(m)))];
+            scores[i] = capturedValue(t.pos, m) * 10 - attacker / 10;
+            if (isPromotion(m)) {
+                scores[i] += PIECE_VALUES[promotionType(m)];
+            }
+            scores[i] += seeGE(t.pos, m) ? CAPTURE_SCORE : -CAPTURE_SCORE;
+        } else if (m == t.killers[ply][0]) {
+            scores[i] = CAPTURE_SCORE - 1;
+        } else if (m == t.killers[ply][1]) {
+            scores[i] = CAPTURE_SCORE - 2;
+        } else {
+            scores[i] = t.history[us][moveFrom(m)][moveTo(m)];
+        }
+    }
+}
+
+int Search::searchNode(ThreadData &t, int alpha, int beta, int depth, int ply, bool pvNode, bool nullAllowed) {
+    if (depth <= 0) {
+        return quiescence(t, alpha, beta, ply);
+    }
+    t.pvLength[ply] = ply;
+    checkLimits(t);
+    if (stopRequested.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    t.nodes.store(t.nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    Position &pos = t.pos;
+
+    if (ply > 0) {
+        if (isDraw(t)) {
+            return VALUE_DRAW;
+        }
+        if (ply >= MAX_PLY - 1) {
+            return staticEvaluation(t, ply);
+        }
+        // Mate distance pruning: no line from here can beat a mate already found closer to the root
+        alpha = std::max(alpha, -VALUE_MATE + ply);
+        beta = std::min(beta, VALUE_MATE - ply - 1);
+        if (alpha >= beta) {
+            return alpha;
+        }
+
+        // Tablebase positions are solved: the distance to mate gives an exact score. Mates too
+        // long to be told apart from search mates just score as won or lost, and mates the
+        // fifty-move rule comes first to score a draw, one centipawn towards the side that had won
+        TbResult tb;
+        if (tablebases && popCount(pos.occupied()) <= tablebases->maxPieces() && tablebases->probe(pos, tb)) {
+            t.tbHits.store(t.tbHits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            int score = VALUE_DRAW + tb.wdl;
+            if (fiftyMoveWdl(pos, tb) != 0) {
+                score = ply + tb.dtm < MAX_PLY ? VALUE_MATE - ply - tb.dtm : VALUE_MATE_IN_MAX_PLY - 1;
+                score = tb.wdl > 0 ? score : -score;
+            }
+            tt.store(pos.hash(), NO_MOVE, scoreToTT(score, ply), VALUE_DRAW, std::min(MAX_PLY - 1, depth + 6), BOUND_EXACT);
+            return score;
+        }
+    }
+
+    bool inCheck = pos.inCheck();
+    TTData tte;
+    bool ttHit = tt.probe(pos.hash(), tte);
+    Move ttMove = ttHit ? tte.move : NO_MOVE;
+    if (ttHit && !pvNode && tte.depth >= depth) {
+        int ttScore = scoreFromTT(tte.score, ply);
+        if (tte.bound == BOUND_EXACT
+            || (tte.bound == BOUND_LOWER && ttScore >= beta)
+            || (tte.bound == BOUND_UPPER && ttScore <= alpha)) {
+            return ttScore;
+        }
+    }
+    int staticEval = inCheck ? -VALUE_INFINITE : (ttHit ? tte.eval : staticEvaluation(t, ply));
+
+    // Null move: if passing still fails high, a real move almost certainly will. Skipped without
+    // pieces, where zugzwang makes passing better than any move
+    Color us = pos.sideToMove();
+    Bitboard nonPawnMaterial = pos.pieces(us) & ~pos.pieces(us, PAWN) & ~pos.pieces(us, KING);
+    if (!pvNode && !inCheck && nullAllowed && depth >= 3 && staticEval >= beta && nonPawnMaterial) {
+        int reduction = 3 + depth / 4;
+        pos.makeNullMove(t.undo[ply]);
+        if (network) {
+            t.accumulators[ply + 1] = t.accumulators[ply];
+        }
+        t.keys[t.keyCount++] = pos.hash();
+        int score = -searchNode(t, -beta, -beta + 1, depth - 1 - reduction, ply + 1, false, false);
+        t.keyCount--;
+        pos.unmakeNullMove(t.undo[ply]);
+        if (stopRequested.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+        if (score >= beta) {
+            return score >= VALUE_MATE_IN_MAX_PLY ? beta : score;
+        }
+    }
+
+    MoveList moves;
+    generateLegalMoves(pos, moves);
+    if (moves.size() == 0) {
+        return inCheck ? -VALUE_MATE + ply : VALUE_DRAW;
+    }
+    if (ply == 0 && rootFilter.size()) {
+        moves = rootFilter;
+    }
+    int scores[256];
+    scoreMoves(t, moves, scores, ttMove, ply);
+
+    int bestScore = -VALUE_INFINITE;
+    Move bestMove = NO_MOVE;
+    Move quietsTried[64];
+    int quietCount = 0;
+
+    for (int i = 0; i < moves.count; i++) {
+        pickNext(moves, scores, i);
+        Move m = moves.moves[i];
+        bool quiet = !isCapture(m) && !isPromotion(m);
+
+        // Near the leaves, skip moves that lose more material in the exchange than the depth
+        // left could plausibly win back. A move is kept once it is the only one searched
+        if (!pvNode && !inCheck && i > 0 && depth <= 6 && bestScore > -VALUE_MATE_IN_MAX_PLY
+            && !seeGE(pos, m, quiet ? -50 * depth : -100 * depth)) {
+            continue;
+        }
+
+        makeMove(t, m, ply);
+        bool givesCheck = pos.inCheck();
+        int newDepth = depth - 1 + (givesCheck ? 1 : 0);   // Check extension
+
+        int score;
+        if (i == 0) {
+            score = -searchNode(t, -beta, -alpha, newDepth, ply + 1, pvNode, true);
+        } else {
+            // Late quiet moves are searched shallower first and only re-searched if they look good
+            int reduction = 0;
+            if (depth >= 3 && i >= 3 && quiet && !inCheck && !givesCheck) {
+                reduction = Reductions[std::min(depth, 63)][std::min(i, 63)];
+                if (pvNode) reduction--;
+                if (m == t.killers[ply][0] || m == t.killers[ply][1]) reduction--;
+                reduction = std::max(0, std::min(reduction, newDepth - 1));
+            }
+            score = -searchNode(t, -alpha - 1, -alpha, newDepth - reduction, ply + 1, false, true);
+            if (score > alpha && reduction > 0) {
+                score = -searchNode(t, -alpha - 1, -alpha, newDepth, ply + 1, false, true);
+            }
+            if (score > alpha && score < beta && pvNode) {
+                score = -searchNode(t, -beta, -alpha, newDepth, ply + 1, true, true);
+            }
+        }
+        unmakeMove(t, m, ply);
+
+        if (stopRequested.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                bestMove = m;
+                t.pv[ply][ply] = m;
+                for (int j = ply + 1; j < t.pvLength[ply + 1]; j++) {
+                    t.pv[ply][j] = t.pv[ply + 1][j];
+                }
+                t.pvLength[ply] = std::max(ply + 1, t.pvLength[ply + 1]);
+
+                if (alpha >= beta) {
+                    if (quiet) {
+                        if (t.killers[ply][0] != m) {
+                            t.killers[ply][1] = t.killers[ply][0];
+                            t.killers[ply][0] = m;
+                        }
+                        int bonus = std::min(depth * depth, 1200);
+                        updateHistory(t.history[us][moveFrom(m)][moveTo(m)], bonus);
+                        for (int j = 0; j < quietCount; j++) {
+                            updateHistory(t.history[us][moveFrom(quietsTried[j])][moveTo(quietsTried[j])], -bonus);
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+        if (quiet && quietCount < 64) {
+            quietsTried[quietCount++] = m;
+        }
+    }
+
+    Bound bound = bestScore >= beta ? BOUND_LOWER : (pvNode && bestMove != NO_MOVE ? BOUND_EXACT : BOUND_UPPER);
+    tt.store(pos.hash(), bestMove, scoreToTT(bestScore, ply), staticEval, depth, bound);
+    return bestScore;
+}
+
+int Search::quiescence(ThreadData &t, int alpha, int beta, int ply) {
+    t.pvLength[ply] = ply;
+    checkLimits(t);
+    if (stopRequested.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    t.nodes.store(t.nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (ply > t.selDepth) {
+        t.selDepth = ply;
+    }
+    Position &pos = t.pos;
+
+    if (isDraw(t)) {
+        return VALUE_DRAW;
+    }
+    if (ply >= MAX_PLY - 1) {
+        return staticEvaluation(t, ply);
+    }
+
+    TTData tte;
+    bool ttHit = tt.probe(pos.hash(), tte);
+    if (ttHit) {
+        int ttScore = scoreFromTT(tte.score, ply);
+        if (tte.bound == BOUND_EXACT
+            || (tte.bound == BOUND_LOWER && ttScore >= beta)
+            || (tte.bound == BOUND_UPPER && ttScore <= alpha)) {
+            return ttScore;
+        }
+    }
+
+    // Stand pat: the side to move can usually do at least as well as the static score by not capturing
+    bool inCheck = pos.inCheck();
+    int staticEval = -VALUE_INFINITE;
+    int bestScore = -VALUE_INFINITE;
+    if (!inCheck) {
+        staticEval = ttHit ? tte.eval : staticEvaluation(t, ply);
+        bestScore = staticEval;
+        if (bestScore >= beta) {
+            return bestScore;
+        }
+        alpha = std::max(alpha, bestScore);
+    }
+
+    MoveList moves;
+    generateLegalMoves(pos, moves, TACTICAL_MOVES);
+    if (inCheck && moves.size() == 0) {
+        return -VALUE_MATE + ply;
+    }
+    int scores[256];
+    scoreMoves(t, moves, scores, ttHit ? tte.move : NO_MOVE, ply);
+
+    int originalAlpha = alpha;
+    Move bestMove = NO_MOVE;
+    for (int i = 0; i < moves.count; i++) {
+        pickNext(moves, scores, i);
+        Move m = moves.moves[i];
+
+        // Delta pruning: skip captures that cannot lift the score to alpha even with a margin,
+        // and captures that lose material once the exchange on the square is played out
+        if (!inCheck && !isPromotion(m)
+            && (staticEval + capturedValue(pos, m) + 200 <= alpha || !seeGE(pos, m))) {
+            continue;
+        }
+
+        makeMove(t, m, ply);
+        int score = -quiescence(t, -beta, -alpha, ply + 1);
+        unmakeMove(t, m, ply);
+
+        if (stopRequested.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                bestMove = m;
+                t.pv[ply][ply] = m;
+                for (int j = ply + 1; j < t.pvLength[ply + 1]; j++) {
+                    t.pv[ply][j] = t.pv[ply + 1][j];
+                }
+                t.pvLength[ply] = std::max(ply + 1, t.pvLength[ply + 1]);
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+
+    Bound bound = bestScore >= beta ? BOUND_LOWER : (bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER);
+    tt.store(pos.hash(), bestMove, scoreToTT(bestScore, ply), staticEval, 0, bound);
+    return bestScore;
+}
+
+void Search::prepareThread(ThreadData &t, const Position &root, const std::vector<uint64_t> &gameKeys) {
+    t.pos = root;
+    t.keyCount = 0;
+    size_t firstKey = gameKeys.size() > 1023 ? gameKeys.size() - 1023 : 0;
+    for (size_t i = firstKey; i < gameKeys.size(); i++) {
+        t.keys[t.keyCount++] = gameKeys[i];
+    }
+    t.keys[t.keyCount++] = root.hash();
+    if (network) {
+        network->refresh(t.accumulators[0], root);
+    }
+    memset(t.killers, 0, sizeof(t.killers));
+    // Keep what the last search learned, but let it fade
+    for (auto &side : t.history) {
+        for (auto &from : side) {
+            for (auto &entry : from) {
+                entry /= 2;
+            }
+        }
+    }
+    t.nodes = 0;
+    t.tbHits = 0;
+    t.selDepth = 0;
+    t.completedDepth = 0;
+    t.score = 0;
+    t.bestMove = NO_MOVE;
+    t.ponderMove = NO_MOVE;
+}
+
+void Search::iterativeDeepening(ThreadData &t) {
+    bool mainThread = t.id == 0;
+    int maxDepth = limits.depth > 0 ? std::min(limits.depth, MAX_PLY - 1) : MAX_PLY - 1;
+    int score = 0;
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        // Odd helpers run one ply ahead so the threads fill the table with different subtrees
+        int searchDepth = std::min(maxDepth, depth + (t.id & 1));
+        t.selDepth = 0;
+
+        // Aspiration window around the last score, widened on every fail
+        int delta = 25;
+        int alpha = -VALUE_INFINITE;
+        int beta = VALUE_INFINITE;
+        if (searchDepth >= 5) {
+            alpha = std::max(score - delta, -VALUE_INFINITE);
+            beta = std::min(score + delta, VALUE_INFINITE);
+        }
+        for (;;) {
+            int iterationScore = searchNode(t, alpha, beta, searchDepth, 0, true, false);
+            if (stopRequested.load(std::memory_order_relaxed)) {
+                break;
+            }
+            if (iterationScore <= alpha) {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(iterationScore - delta, -VALUE_INFINITE);
+            } else if (iterationScore >= beta) {
+                beta = std::min(iterationScore + delta, VALUE_INFINITE);
+            } else {
+                score = iterationScore;
+                break;
+            }
+            delta += delta / 2;
+        }
+        // An interrupted iteration is incomplete, so the previous one's result stands
+        if (stopRequested.load(std::memory_order_relaxed)) {
+            break;
+        }
+
+        t.completedDepth = searchDepth;
+        t.score = score;
+        t.bestMove = t.pv[0][0];
+        t.ponderMove = t.pvLength[0] > 1 ? t.pv[0][1] : NO_MOVE;
+        if (!mainThread) {
+            continue;
+        }
+
+        int64_t elapsed = elapsedMs();
+        if (reportCallback) {
+            SearchReport report;
+            report.depth = searchDepth;
+            report.selDepth = t.selDepth;
+            report.score = score;
+            report.nodes = totalNodes();
+            report.timeMs = elapsed;
+            report.nps = elapsed > 0 ? report.nodes * 1000 / elapsed : report.nodes * 1000;
+            report.hashfull = tt.hashfull();
+            report.tbHits = totalTbHits();
+            report.pvLength = t.pvLength[0];
+            for (int i = 0; i < t.pvLength[0]; i++) {
+                report.pv[i] = t.pv[0][i];
+            }
+            reportCallback(report);
+        }
+
+        if (softLimitMs && !pondering.load(std::memory_order_relaxed) && elapsed >= softLimitMs) {
+            break;
+        }
+        // Once a mate is proven well below the horizon, deeper iterations will not find a shorter one
+        if (!limits.infinite && std::abs(score) >= VALUE_MATE_IN_MAX_PLY && depth > 2 * (VALUE_MATE - std::abs(score)) + 4) {
+            break;
+        }
+    }
+}
+
+SearchResult Search::think(const Position &root, const std::vector<uint64_t> &gameKeys, const SearchLimits &searchLimits) {
+    limits = searchLimits;
+    stopRequested = false;
+    pondering = limits.ponder;
+    startTime = Clock::now();
+    setTimeLimits(root.sideToMove());
+    tt.newSearch();
+
+    SearchResult result;
+    MoveList rootMoves;
+    generateLegalMoves(root, rootMoves);
+    if (rootMoves.size() == 0) {
+        return result;
+    }
+    // In the tablebases only the moves that keep the result are searched, so a won position
+    // is never given away to a search that cannot see the win
+    rootFilter.clear();
+    if (tablebases && tablebases->rootMoves(root, rootFilter)) {
+        rootMoves = rootFilter;
+    }
+
+    for (auto &t : threads) {
+        prepareThread(*t, root, gameKeys);
+    }
+    std::vector<std::future<void>> running;
+    for (size_t i = 1; i < threads.size(); i++) {
+        ThreadData* t = threads[i].get();
+        running.push_back(helpers->submit([this, t] { iterativeDeepening(*t); }));
+    }
+    iterativeDeepening(*threads[0]);
+
+    // A GUI that sent "go infinite" or "go ponder" expects no best move before it says stop
+    while (!stopRequested.load() && (limits.infinite || pondering.load())) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stopRequested = true;
+    for (auto &future : running) {
+        future.get();
+    }
+
+    // Take the deepest completed iteration, preferring the main thread on a tie
+    const ThreadData* best = threads[0].get();
+    for (auto &t : threads) {
+        if (t->completedDepth > best->completedDepth && t->bestMove != NO_MOVE) {
+            best = t.get();
+        }
+    }
+    // Something legal to play even if the first iteration was cut short
+    result.bestMove = best->bestMove != NO_MOVE ? best->bestMove : rootMoves[0];
+    result.ponderMove = best->ponderMove;
+    result.score = best->score;
+    result.depth = best->completedDepth;
+    result.nodes = totalNodes();
+    result.timeMs = elapsedMs();
+    return result;
+}
@@ -0,0 +1,157 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_SEARCH_H
+#define EXAMAUTUMN2023_SEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Evaluation.h"
+#include "Move.h"
+#include "Nnue.h"
+#include "Position.h"
+#include "Tablebase.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+
+constexpr int MAX_PLY = 128;
+constexpr int VALUE_DRAW = 0;
+constexpr int VALUE_MATE = 32000;
+constexpr int VALUE_INFINITE = 32001;
+constexpr int VALUE_MATE_IN_MAX_PLY = VALUE_MATE - MAX_PLY;
+
+// When to stop searching. Zero means "no limit" for every field
+struct SearchLimits {
+    int depth = 0;
+    uint64_t nodes = 0;
+    int64_t moveTime = 0;           // Milliseconds for this move
+    int64_t time[2] = {0, 0};       // Milliseconds left on each side's clock
+    int64_t increment[2] = {0, 0};
+    int movesToGo = 0;
+    bool infinite = false;
+    bool ponder = false;            // Clock limits only apply after ponderHit()
+};
+
+// Sent after every completed iteration
+struct SearchReport {
+    int depth;
+    int selDepth;
+    int score;              // Centipawns, or +-(VALUE_MATE - plies) for a forced mate
+    uint64_t nodes;
+    int64_t timeMs;
+    uint64_t nps;
+    int hashfull;
+    uint64_t tbHits;
+    Move pv[MAX_PLY];
+    int pvLength;
+};
+
+struct SearchResult {
+    Move bestMove = NO_MOVE;
+    Move ponderMove = NO_MOVE;
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+};
+
+/**
+ * Iterative deepening principal variation search with aspiration windows,
+ * quiescence search, null-move pruning, late-move reductions and
+ * killer/history move ordering. All per-node state lives in fixed arrays,
+ * so searching does not allocate.
+ *
+ * With more than one thread the search is Lazy SMP: helper threads search
+ * the same root, half of them one ply deeper, and share only the
+ * transposition table. The first thread owns time control and reporting.
+ */
+class Search {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // Everything the recursion touches, kept together so one object is one search thread.
+    // Cache line aligned so the hot counters of two threads never share a line
+    struct alignas(64) ThreadData {
+        int id;
+        Position pos;
+        UndoRecord undo[MAX_PLY];
+        uint64_t keys[1024 + MAX_PLY];  // Keys of the game so far followed by the current search line
+        int keyCount;
+        Move killers[MAX_PLY][2];
+        int history[2][64][64];
+        PawnTable pawns;
+        Nnue::Accumulator accumulators[MAX_PLY + 1];    // Entry ply belongs to the position at ply
+        Move pv[MAX_PLY][MAX_PLY];
+        int pvLength[MAX_PLY];
+        std::atomic<uint64_t> nodes;    // Only written by the owning thread, read by the main thread
+        std::atomic<uint64_t> tbHits;
+        int selDepth;
+
+        // Result of the last completed iteration
+        int completedDepth;
+        int score;
+        Move bestMove;
+        Move ponderMove;
+    };
+
+    TranspositionTable &tt;
+    const Nnue::Network* network = nullptr;
+    const Tablebases* tablebases = nullptr;
+    MoveList rootFilter;        // Root moves that keep the tablebase result, empty outside the tablebases
+    std::vector<std::unique_ptr<ThreadData>> threads;
+    std::unique_ptr<ThreadPool> helpers;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> pondering{false};
+    std::function<void(const SearchReport&)> reportCallback;
+
+    SearchLimits limits;
+    Clock::time_point startTime;
+    int64_t softLimitMs = 0;    // Do not start another iteration after this
+    int64_t hardLimitMs = 0;    // Abort the search in progress after this
+
+    void prepareThread(ThreadData &t, const Position &root, const std::vector<uint64_t> &gameKeys);
+    void iterativeDeepening(ThreadData &t);
+    int searchNode(ThreadData &t, int alpha, int beta, int depth, int ply, bool pvNode, bool nullAllowed);
+    int quiescence(ThreadData &t, int alpha, int beta, int ply);
+    void scoreMoves(const ThreadData &t, const MoveList &moves, int scores[], Move ttMove, int ply) const;
+    bool isDraw(const ThreadData &t) const;
+    int staticEvaluation(ThreadData &t, int ply) const;
+    void makeMove(ThreadData &t, Move m, int ply);
+    void unmakeMove(ThreadData &t, Move m, int ply);
+    void checkLimits(const ThreadData &t);
+    void setTimeLimits(Color us);
+    int64_t elapsedMs() const;
+    uint64_t totalNodes() const;
+    uint64_t totalTbHits() const;
+
+public:
+    explicit Search(TranspositionTable &tt, unsigned threadCount = 1);
+
+    // Not to be called while think() is running
+    void setThreads(unsigned threadCount);
+    unsigned threadCount() const { return (unsigned) threads.size(); }
+    // Evaluates with network instead of the classical evaluation, or with the classical one again
+    // for nullptr. The network must stay loaded while searches use it. Not while think() runs
+    void setNetwork(const Nnue::Network* network) { this->network = network; }
+    // Probes tablebases at the root and in the tree, nullptr to stop. Not while think() runs
+    void setTablebases(const Tablebases* tablebases) { this->tablebases = tablebases; }
+
+    /**
+     * Searches root until a limit is hit or stop() is called. Infinite and
+     * ponder searches only return after stop(), as UCI expects.
+     * @param gameKeys - Zobrist keys of the positions before root in the game, for repetition detection
+     */
+    SearchResult think(const Position &root, const std::vector<uint64_t> &gameKeys, const SearchLimits &limits);
+    // Safe to call from another thread; think() returns its best move shortly after
+    void stop() { stopRequested = true; }
+    // The predicted move was played: switch a ponder search over to normal time control
+    void ponderHit() { pondering = false; }
+    void setReportCallback(std::function<void(const SearchReport&)> callback) { reportCallback = std::move(callback); }
+};
+
+#endif //EXAMAUTUMN2023_SEARCH_H
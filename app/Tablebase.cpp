@@ -0,0 +1,667 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Tablebase.h"
+#include "MoveGen.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <mutex>
+
+namespace {
+    const char TABLE_MAGIC[4] = {'C', 'S', 'T', 'B'};
+    constexpr uint32_t TABLE_VERSION = 1;
+
+    struct TableHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t materialKey;
+        uint64_t entries;           // Per side to move
+        uint32_t pieces;
+        char signature[20];         // Zero terminated, for people looking at the file
+        char reserved[16];
+    };
+    static_assert(sizeof(TableHeader) == 64, "the positions start at byte 64");
+
+    // Low two bits of an entry, the distance to mate in plies above them
+    enum EntryCode {
+        ENTRY_DRAW,
+        ENTRY_WIN,
+        ENTRY_LOSS,
+        ENTRY_ILLEGAL   // Side not to move in check, pieces on top of each other, pawns on the back rank
+    };
+    // Only while a table is being generated: not solved yet
+    constexpr uint16_t ENTRY_UNKNOWN = 0xFFFF;
+
+    uint16_t makeEntry(EntryCode code, int dtm) {
+        return (uint16_t) (dtm << 2 | code);
+    }
+
+    // Non-king pieces in index order, strongest first
+    constexpr ChessPieceType ORDER[5] = {QUEEN, ROOK, BISHOP, KNIGHT, PAWN};
+    constexpr char LETTERS[6] = "QRBNP";
+
+    /**
+     * The material key packs one side's piece counts into a nibble each, queens in the highest,
+     * and puts the stronger side's 20 bits above the weaker side's. Comparing the sides' halves
+     * decides which one is stronger, so the key is the same with colours swapped.
+     */
+    uint64_t sideKey(const Position &pos, Color color) {
+        uint64_t key = 0;
+        for (ChessPieceType type : ORDER) {
+            key = key << 4 | (uint64_t) popCount(pos.pieces(color, type));
+        }
+        return key;
+    }
+
+    int countOf(uint64_t materialKey, int strongSide, int order) {
+        return (int) ((materialKey >> ((1 - strongSide) * 20 + (4 - order) * 4)) & 0xF);
+    }
+
+    int pieceCount(uint64_t materialKey) {
+        int count = 2;
+        for (int side = 0; side < 2; side++) {
+            for (int i = 0; i < 5; i++) {
+                count += countOf(materialKey, side, i);
+            }
+        }
+        return count;
+    }
+
+    bool hasPawns(uint64_t materialKey) {
+        return countOf(materialKey, 0, 4) || countOf(materialKey, 1, 4);
+    }
+
+    // Sorts the two halves so the stronger side comes first
+    uint64_t canonicalKey(uint64_t first, uint64_t second) {
+        return first >= second ? first << 20 | second : second << 20 | first;
+    }
+
+    // Without pawns the stronger king is mirrored into the a1-d1-d4 triangle
+    struct Triangle {
+        int index[64];
+        int squares[10];
+
+        Triangle() {
+            int count = 0;
+            for (int sq = 0; sq < 64; sq++) {
+                bool inside = fileOf(sq) <= 3 && rankOf(sq) <= fileOf(sq);
+                index[sq] = inside ? count : -1;
+                if (inside) {
+                    squares[count++] = sq;
+                }
+            }
+        }
+    };
+    const Triangle TRIANGLE;
+
+    uint64_t tableEntries(uint64_t materialKey) {
+        uint64_t entries = hasPawns(materialKey) ? 32 : 10;
+        for (int i = 1; i < pieceCount(materialKey); i++) {
+            entries *= 64;
+        }
+        return entries;
+    }
+
+    int transpose(int sq) {
+        return fileOf(sq) * 8 + rankOf(sq);
+    }
+
+    /**
+     * Index of pos in its table, side to move included. The squares are listed stronger king,
+     * weaker king, then the stronger and the weaker side's pieces in ORDER, and are reflected
+     * until the stronger king is in the part of the board the table covers.
+     */
+    uint64_t encode(const Position &pos, uint64_t &materialKey) {
+        uint64_t white = sideKey(pos, WHITE);
+        uint64_t black = sideKey(pos, BLACK);
+        Color strong = black > white ? BLACK : WHITE;
+        materialKey = canonicalKey(white, black);
+        bool pawns = hasPawns(materialKey);
+
+        int squares[TB_MAX_PIECES];
+        int n = 0;
+        squares[n++] = pos.kingSquare(strong);
+        squares[n++] = pos.kingSquare(~strong);
+        for (Color color : {strong, ~strong}) {
+            for (ChessPieceType type : ORDER) {
+                Bitboard bb = pos.pieces(color, type);
+                while (bb) {
+                    squares[n++] = popLsb(bb);
+                }
+            }
+        }
+
+        int flip = (strong == BLACK ? 56 : 0) ^ (fileOf(squares[0]) > 3 ? 7 : 0);
+        if (!pawns && rankOf(squares[0] ^ flip) > 3) {
+            flip ^= 56;
+        }
+        for (int i = 0; i < n; i++) {
+            squares[i] ^= flip;
+        }
+        if (!pawns && rankOf(squares[0]) > fileOf(squares[0])) {
+            for (int i = 0; i < n; i++) {
+                squares[i] = transpose(squares[i]);
+            }
+        }
+
+        uint64_t index = pawns ? rankOf(squares[0]) * 4 + fileOf(squares[0]) : TRIANGLE.index[squares[0]];
+        for (int i = 1; i < n; i++) {
+            index = index * 64 + squares[i];
+        }
+        int stm = pos.sideToMove() ^ (strong == BLACK ? 1 : 0);
+        return stm * tableEntries(materialKey) + index;
+    }
+
+    // Sets up the position at index, white being the stronger side. False if it cannot occur in a game
+    bool decode(uint64_t materialKey, uint64_t index, Position &pos) {
+        uint64_t entries = tableEntries(materialKey);
+        Color stm = index >= entries ? BLACK : WHITE;
+        index %= entries;
+
+        int n = pieceCount(materialKey);
+        int squares[TB_MAX_PIECES];
+        for (int i = n - 1; i > 0; i--) {
+            squares[i] = (int) (index % 64);
+            index /= 64;
+        }
+        squares[0] = hasPawns(materialKey) ? (int) (index / 4 * 8 + index % 4) : TRIANGLE.squares[index];
+
+        pos.clear();
+        pos.putPiece(makePiece(KING, WHITE), squares[0]);
+        if (!pos.isEmpty(squares[1])) {
+            return false;
+        }
+        pos.putPiece(makePiece(KING, BLACK), squares[1]);
+        int next = 2;
+        for (int side = 0; side < 2; side++) {
+            for (int i = 0; i < 5; i++) {
+                for (int count = countOf(materialKey, side, i); count > 0; count--) {
+                    int sq = squares[next++];
+                    if (!pos.isEmpty(sq) || (ORDER[i] == PAWN && (rankOf(sq) == 0 || rankOf(sq) == 7))) {
+                        return false;
+                    }
+                    pos.putPiece(makePiece(ORDER[i], (Color) side), sq);
+                }
+            }
+        }
+        pos.setState(stm, 0, NO_SQUARE, 0, 1);
+        // The side that just moved cannot have left its king in check. Covers touching kings too
+        return !(pos.attackersTo(pos.kingSquare(~stm), pos.occupied()) & pos.pieces(stm));
+    }
+
+    // The result of a child position seen from the side that moved into it
+    TbResult fromChild(const TbResult &child) {
+        return {-child.wdl, child.wdl ? child.dtm + 1 : 0};
+    }
+
+    // Wins by the fastest mate first, losses by the slowest mate last
+    int preference(const TbResult &result) {
+        return result.wdl > 0 ? 100000 - result.dtm : (result.wdl < 0 ? -100000 + result.dtm : 0);
+    }
+
+    // fetch(materialKey, index, value) fills value with the entry, returns false if the table is missing
+    template<class Fetch>
+    bool lookup(uint64_t materialKey, uint64_t index, const Fetch &fetch, TbResult &result, bool &unknown) {
+        result = {0, 0};
+        if (materialKey == 0) {
+            return true;    // Bare kings
+        }
+        uint16_t value;
+        if (!fetch(materialKey, index, value)) {
+            return false;
+        }
+        if (value == ENTRY_UNKNOWN) {
+            unknown = true;
+            return true;
+        }
+        int code = value & 3;
+        result = {code == ENTRY_WIN ? 1 : (code == ENTRY_LOSS ? -1 : 0), value >> 2};
+        return code != ENTRY_ILLEGAL;
+    }
+
+    /**
+     * Result of pos through fetch. The tables hold positions without an en passant square,
+     * so when there is one the side to move gets the better of the position without it and
+     * every en passant capture. unknown is set if any position looked at is not solved yet.
+     */
+    template<class Fetch>
+    bool resolve(const Position &pos, const Fetch &fetch, TbResult &result, bool &unknown) {
+        uint64_t materialKey;
+        if (pos.enPassantSquare() == NO_SQUARE) {
+            uint64_t index = encode(pos, materialKey);
+            return lookup(materialKey, index, fetch, result, unknown);
+        }
+        Position plain = pos;
+        plain.setState(pos.sideToMove(), pos.castlingRights(), NO_SQUARE, pos.halfmoves(), pos.fullmoves());
+        uint64_t index = encode(plain, materialKey);
+        if (!lookup(materialKey, index, fetch, result, unknown)) {
+            return false;
+        }
+        MoveList moves;
+        generateLegalMoves(pos, moves, TACTICAL_MOVES);
+        for (Move m : moves) {
+            if (moveFlags(m) != EP_CAPTURE) {
+                continue;
+            }
+            Position child = pos;
+            UndoRecord undo;
+            child.makeMove(m, undo);
+            TbResult childResult;
+            if (!resolve(child, fetch, childResult, unknown)) {
+                return false;
+            }
+            if (preference(fromChild(childResult)) > preference(result)) {
+                result = fromChild(childResult);
+            }
+        }
+        return true;
+    }
+
+    // Parses "KRPvKR"; false unless both sides have exactly one king and the pieces fit a table
+    bool parseSignature(const std::string &signature, uint64_t &materialKey) {
+        size_t split = signature.find('v');
+        if (split == std::string::npos) {
+            return false;
+        }
+        uint64_t sides[2];
+        std::string parts[2] = {signature.substr(0, split), signature.substr(split + 1)};
+        for (int side = 0; side < 2; side++) {
+            const std::string &part = parts[side];
+            if (part.empty() || part[0] != 'K') {
+                return false;
+            }
+            int counts[5] = {};
+            for (size_t i = 1; i < part.size(); i++) {
+                const char* letter = strchr(LETTERS, part[i]);
+                if (!letter || !*letter) {
+                    return false;
+                }
+                counts[letter - LETTERS]++;
+            }
+            sides[side] = 0;
+            for (int count : counts) {
+                if (count > 15) {
+                    return false;
+                }
+                sides[side] = sides[side] << 4 | (uint64_t) count;
+            }
+        }
+        materialKey = canonicalKey(sides[0], sides[1]);
+        return pieceCount(materialKey) <= TB_MAX_PIECES;
+    }
+
+    std::string signatureOf(uint64_t materialKey) {
+        std::string signature;
+        for (int side = 0; side < 2; side++) {
+            signature += side ? "vK" : "K";
+            for (int i = 0; i < 5; i++) {
+                signature.append((size_t) countOf(materialKey, side, i), LETTERS[i]);
+            }
+        }
+        return signature;
+    }
+}
+
+void Tablebases::clear() {
+    tables.clear();
+    largest = 0;
+    openCount = 0;
+}
+
+int Tablebases::init(const std::string &directory, size_t maxOpen) {
+    clear();
+    this->maxOpen = std::max<size_t>(1, maxOpen);
+    std::error_code error;
+    for (const auto &file : std::filesystem::directory_iterator(directory, error)) {
+        if (file.path().extension() != ".ctb") {
+            continue;
+        }
+        // Only the header is read here, the positions are mapped when a probe needs them
+        TableHeader header;
+        FILE* in = fopen(file.path().string().c_str(), "rb");
+        if (!in) {
+            continue;
+        }
+        bool ok = fread(&header, sizeof(header), 1, in) == 1;
+        fclose(in);
+        if (!ok || memcmp(header.magic, TABLE_MAGIC, 4) != 0 || header.version != TABLE_VERSION
+            || (int) header.pieces != pieceCount(header.materialKey) || header.pieces > TB_MAX_PIECES
+            || header.entries != tableEntries(header.materialKey)) {
+            continue;
+        }
+        auto table = std::make_unique<Table>();
+        table->path = file.path().string();
+        table->materialKey = header.materialKey;
+        table->entries = header.entries;
+        largest = std::max(largest, (int) header.pieces);
+        tables[header.materialKey] = std::move(table);
+    }
+    return (int) tables.size();
+}
+
+bool Tablebases::mapTable(Table &table) const {
+    if (openCount >= maxOpen) {
+        Table* oldest = nullptr;
+        for (auto &entry : tables) {
+            Table &candidate = *entry.second;
+            if (candidate.data && (!oldest || candidate.lastUse.load() < oldest->lastUse.load())) {
+                oldest = &candidate;
+            }
+        }
+        if (oldest) {
+            oldest->file.reset();
+            oldest->data = nullptr;
+            openCount--;
+        }
+    }
+    auto file = std::make_unique<MappedFile>();
+    if (!file->open(table.path, MappedFile::RANDOM)
+        || file->size() != sizeof(TableHeader) + 2 * table.entries * sizeof(uint16_t)) {
+        return false;
+    }
+    table.data = (const uint16_t*) (file->data() + sizeof(TableHeader));
+    table.file = std::move(file);
+    openCount++;
+    return true;
+}
+
+bool Tablebases::entry(uint64_t materialKey, uint64_t index, uint16_t &value) const {
+    auto found = tables.find(materialKey);
+    if (found == tables.end()) {
+        return false;
+    }
+    Table &table = *found->second;
+    table.lastUse.store(useClock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        if (table.data) {
+            value = table.data[index];
+            return true;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    // Another thread may have mapped it in between
+    if (!table.data && !mapTable(table)) {
+        return false;
+    }
+    value = table.data[index];
+    return true;
+}
+
+bool Tablebases::probe(const Position &pos, TbResult &result) const {
+    if (pos.castlingRights() || popCount(pos.occupied()) > largest) {
+        return false;
+    }
+    auto fetch = [this](uint64_t materialKey, uint64_t index, uint16_t &value) {
+        return entry(materialKey, index, value);
+    };
+    bool unknown = false;
+    return resolve(pos, fetch, result, unknown);
+}
+
+bool Tablebases::rootMoves(const Position &root, MoveList &moves) const {
+    moves.clear();
+    TbResult rootResult;
+    if (!probe(root, rootResult)) {
+        return false;
+    }
+    // A capture or pawn move restarts the fifty-move count, so a move can keep a win that the
+    // root's own distance to mate would lose to the rule: the best child decides, not the root.
+    // Moves rank by their result under the rule, then by their result without it
+    MoveList legal;
+    generateLegalMoves(root, legal);
+    int results[256];
+    int best = -4;
+    for (int i = 0; i < legal.size(); i++) {
+        Position child = root;
+        UndoRecord undo;
+        child.makeMove(legal[i], undo);
+        TbResult childResult;
+        if (!probe(child, childResult)) {
+            return false;
+        }
+        results[i] = -3 * fiftyMoveWdl(child, childResult) - childResult.wdl;
+        best = std::max(best, results[i]);
+    }
+    for (int i = 0; i < legal.size(); i++) {
+        if (results[i] == best) {
+            moves.add(legal[i]);
+        }
+    }
+    return true;
+}
+
+std::string Tablebases::normalize(const std::string &signature) {
+    uint64_t materialKey;
+    return parseSignature(signature, materialKey) ? signatureOf(materialKey) : std::string();
+}
+
+std::vector<std::string> Tablebases::subtables(const std::string &signature) {
+    std::vector<std::string> result;
+    uint64_t materialKey;
+    if (!parseSignature(signature, materialKey)) {
+        return result;
+    }
+    int counts[2][5];
+    for (int side = 0; side < 2; side++) {
+        for (int i = 0; i < 5; i++) {
+            counts[side][i] = countOf(materialKey, side, i);
+        }
+    }
+    auto add = [&]() {
+        uint64_t sides[2] = {0, 0};
+        for (int side = 0; side < 2; side++) {
+            for (int i = 0; i < 5; i++) {
+                sides[side] = sides[side] << 4 | (uint64_t) counts[side][i];
+            }
+        }
+        uint64_t key = canonicalKey(sides[0], sides[1]);
+        std::string name = signatureOf(key);
+        if (key != 0 && std::find(result.begin(), result.end(), name) == result.end()) {
+            result.push_back(name);
+        }
+    };
+    for (int side = 0; side < 2; side++) {
+        // Captures of any piece
+        for (int i = 0; i < 5; i++) {
+            if (counts[side][i]) {
+                counts[side][i]--;
+                add();
+                counts[side][i]++;
+            }
+        }
+        // Promotions, with and without a capture on the back rank where there are no pawns
+        if (!counts[side][4]) {
+            continue;
+        }
+        counts[side][4]--;
+        for (int promotion = 0; promotion < 4; promotion++) {
+            counts[side][promotion]++;
+            add();
+            for (int i = 0; i < 4; i++) {
+                if (counts[1 - side][i]) {
+                    counts[1 - side][i]--;
+                    add();
+                    counts[1 - side][i]++;
+                }
+            }
+            counts[side][promotion]--;
+        }
+        counts[side][4]++;
+    }
+    return result;
+}
+
+bool Tablebases::generate(const std::string &signature, const std::string &directory, const Tablebases &tablebases,
+                          unsigned threads, void (*log)(const std::string&)) {
+    uint64_t materialKey;
+    if (!parseSignature(signature, materialKey)) {
+        return false;
+    }
+    std::string name = signatureOf(materialKey);
+    const uint64_t total = 2 * tableEntries(materialKey);
+    std::vector<uint16_t> current((size_t) total);
+    std::vector<uint16_t> next;
+
+    // Positions of this table come from the previous pass, everything else from the finished tables
+    auto fetch = [&](uint64_t key, uint64_t index, uint16_t &value) {
+        if (key == materialKey) {
+            value = current[index];
+            return true;
+        }
+        return tablebases.entry(key, index, value);
+    };
+
+    struct ChunkResult {
+        uint64_t solved = 0;
+        int pending = INT32_MAX;    // Shortest known loss still waiting for its pass
+        bool missing = false;       // A table a capture or promotion leads to is not there
+    };
+    ThreadPool pool(std::max(1u, threads));
+    constexpr uint64_t CHUNK = 1 << 16;
+    auto runPass = [&](auto work) {
+        std::vector<std::future<ChunkResult>> futures;
+        for (uint64_t begin = 0; begin < total; begin += CHUNK) {
+            uint64_t end = std::min(total, begin + CHUNK);
+            futures.push_back(pool.submit([&work, begin, end] { return work(begin, end); }));
+        }
+        ChunkResult sum;
+        for (auto &future : futures) {
+            ChunkResult chunk = future.get();
+            sum.solved += chunk.solved;
+            sum.pending = std::min(sum.pending, chunk.pending);
+            sum.missing |= chunk.missing;
+        }
+        return sum;
+    };
+
+    // Mates and stalemates first, everything else is unknown
+    ChunkResult start = runPass([&](uint64_t begin, uint64_t end) {
+        ChunkResult result;
+        Position pos;
+        MoveList moves;
+        for (uint64_t i = begin; i < end; i++) {
+            if (!decode(materialKey, i, pos)) {
+                current[i] = makeEntry(ENTRY_ILLEGAL, 0);
+                continue;
+            }
+            moves.clear();
+            generateLegalMoves(pos, moves);
+            current[i] = moves.size() ? ENTRY_UNKNOWN : makeEntry(pos.inCheck() ? ENTRY_LOSS : ENTRY_DRAW, 0);
+            result.solved += moves.size() == 0;
+        }
+        return result;
+    });
+
+    /**
+     * Pass k: a position wins in d plies once some move leads to a known loss in d - 1 < k plies,
+     * and loses once every move leads to a known win. By induction every position with a mate
+     * in d plies is solved by pass d, so no shorter loss can still be unknown when a win is
+     * taken. Losses from tables reached by captures can be long, passes in which nothing can
+     * change are skipped.
+     */
+    int pass = 1;
+    uint64_t solved = start.solved;
+    for (;;) {
+        next = current;
+        ChunkResult result = runPass([&](uint64_t begin, uint64_t end) {
+            ChunkResult chunk;
+            Position pos;
+            MoveList moves;
+            UndoRecord undo;
+            for (uint64_t i = begin; i < end; i++) {
+                if (current[i] != ENTRY_UNKNOWN) {
+                    continue;
+                }
+                decode(materialKey, i, pos);
+                moves.clear();
+                generateLegalMoves(pos, moves);
+                int shortestLoss = INT32_MAX;
+                int longestWin = 0;
+                bool allWins = true;
+                for (Move m : moves) {
+                    pos.makeMove(m, undo);
+                    TbResult child;
+                    bool unknown = false;
+                    bool found = resolve(pos, fetch, child, unknown);
+                    pos.unmakeMove(m, undo);
+                    if (!found) {
+                        chunk.missing = true;
+                        return chunk;
+                    }
+                    if (unknown || child.wdl <= 0) {
+                        allWins = false;
+                    }
+                    if (unknown) {
+                        continue;
+                    }
+                    if (child.wdl < 0) {
+                        shortestLoss = std::min(shortestLoss, child.dtm);
+                    } else if (child.wdl > 0) {
+                        longestWin = std::max(longestWin, child.dtm);
+                    }
+                }
+                if (shortestLoss < pass) {
+                    next[i] = makeEntry(ENTRY_WIN, shortestLoss + 1);
+                    chunk.solved++;
+                } else if (allWins) {
+                    next[i] = makeEntry(ENTRY_LOSS, longestWin + 1);
+                    chunk.solved++;
+                } else if (shortestLoss != INT32_MAX) {
+                    chunk.pending = std::min(chunk.pending, shortestLoss);
+                }
+            }
+            return chunk;
+        });
+        if (result.missing) {
+            if (log) log(name + ": a table reached by a capture or promotion is missing");
+            return false;
+        }
+        current.swap(next);
+        solved += result.solved;
+        if (log) log(name + ": pass " + std::to_string(pass) + ", " + std::to_string(result.solved) + " solved");
+        if (result.solved) {
+            pass++;
+        } else if (result.pending != INT32_MAX) {
+            pass = result.pending + 1;
+        } else {
+            break;
+        }
+    }
+
+    // Whatever is still unknown can never be forced either way
+    uint64_t counts[4] = {};
+    for (uint16_t &value : current) {
+        if (value == ENTRY_UNKNOWN) {
+            value = makeEntry(ENTRY_DRAW, 0);
+        }
+        counts[value & 3]++;
+    }
+    if (log) {
+        log(name + ": " + std::to_string(counts[ENTRY_WIN]) + " wins, " + std::to_string(counts[ENTRY_DRAW])
+            + " draws, " + std::to_string(counts[ENTRY_LOSS]) + " losses, "
+            + std::to_string(counts[ENTRY_ILLEGAL]) + " illegal");
+    }
+
+    TableHeader header = {};
+    memcpy(header.magic, TABLE_MAGIC, 4);
+    header.version = TABLE_VERSION;
+    header.materialKey = materialKey;
+    header.entries = total / 2;
+    header.pieces = (uint32_t) pieceCount(materialKey);
+    strncpy(header.signature, name.c_str(), sizeof(header.signature) - 1);
+    std::string path = (std::filesystem::path(directory) / (name + ".ctb")).string();
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) {
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1
+              && fwrite(current.data(), sizeof(uint16_t), current.size(), out) == current.size();
+    ok = fclose(out) == 0 && ok;
+    return ok;
+}
@@ -0,0 +1,120 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_TABLEBASE_H
+#define EXAMAUTUMN2023_TABLEBASE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "MappedFile.h"
+#include "Move.h"
+#include "Position.h"
+
+// Kings included. A 5 piece table with pawns holds 2 * 32 * 64^4 entries, a 2 GB file that takes
+// twice that in memory while it is generated; a 6 piece one would be 64 times as large
+constexpr int TB_MAX_PIECES = 5;
+
+// Perfect-play result for the side to move
+struct TbResult {
+    int wdl;    // 1 win, 0 draw, -1 loss
+    int dtm;    // Plies to mate with best play from both sides, 0 for draws
+};
+
+/**
+ * The result with the fifty-move rule approximated: a win or loss whose mate lies more than 100
+ * half-moves after the last capture or pawn move of pos counts as a draw. The tables store the
+ * distance to mate, not the distance to the next capture or pawn move (DTZ) the rule needs, and
+ * a capture or pawn move on the way to mate restarts the count. So this leans towards draws: many
+ * long wins that could still be converted in time are reported as draws.
+ */
+inline int fiftyMoveWdl(const Position &pos, const TbResult &result) {
+    return pos.halfmoves() + result.dtm > 100 ? 0 : result.wdl;
+}
+
+/**
+ * Endgame tablebases: every position with few enough pieces solved by
+ * retrograde analysis (chess-tbgen), one file per material combination such
+ * as KRPvKR.ctb. A file holds a 64 byte header ("CSTB", version, material)
+ * followed by one little-endian uint16 per position and side to move:
+ * bits 0-1 are draw / win / loss / illegal, the rest the distance to mate
+ * in plies.
+ *
+ * Positions are indexed by the squares of the pieces in a fixed order, with
+ * the stronger side's king moved into one eighth of the board (a quarter with
+ * pawns) through the board's symmetries, and with the colours swapped when
+ * black is the stronger side. Castling rights are not covered and the fifty
+ * move rule is left to fiftyMoveWdl(). En passant captures are resolved by
+ * probing the positions after them.
+ *
+ * init() only scans the directory. A file is mapped on the first probe that
+ * needs it, and at most maxOpen files stay mapped: the least recently used
+ * one is unmapped to make room. Probes may run from any number of threads.
+ */
+class Tablebases {
+private:
+    struct Table {
+        std::string path;
+        uint64_t materialKey;
+        uint64_t entries;                   // Positions per side to move
+        std::unique_ptr<MappedFile> file;   // Null while not mapped
+        const uint16_t* data = nullptr;
+        std::atomic<uint64_t> lastUse{0};
+    };
+
+    std::unordered_map<uint64_t, std::unique_ptr<Table>> tables;    // By material key
+    int largest = 0;                    // Most pieces in any table
+    size_t maxOpen = 16;
+
+    // Shared by probes reading mapped tables, exclusive while a table is mapped or unmapped
+    mutable std::shared_mutex mutex;
+    mutable std::atomic<uint64_t> useClock{0};
+    mutable size_t openCount = 0;
+
+    bool mapTable(Table &table) const;
+    bool entry(uint64_t materialKey, uint64_t index, uint16_t &value) const;
+
+public:
+    Tablebases() = default;
+    Tablebases(const Tablebases&) = delete;
+    Tablebases &operator=(const Tablebases&) = delete;
+
+    /**
+     * Replaces the tables with the *.ctb files in directory. Not to be called while probes run.
+     * @return the number of tables found
+     */
+    int init(const std::string &directory, size_t maxOpen = 16);
+    void clear();
+    // Most pieces, kings included, of any table; 0 without tables
+    int maxPieces() const { return largest; }
+    size_t tableCount() const { return tables.size(); }
+
+    // False if pos is not covered: too many pieces, castling rights or no file for its material
+    bool probe(const Position &pos, TbResult &result) const;
+    /**
+     * Fills moves with the legal moves of root that reach its best result under fiftyMoveWdl(). Among
+     * moves that rate as draws, those that are still wins without the rule come first, so a win the
+     * approximation gives up on is not traded for a real draw.
+     * @return false if root is not covered, moves is then left empty
+     */
+    bool rootMoves(const Position &root, MoveList &moves) const;
+
+    /**
+     * Solves one material combination ("KQvKR") and writes signature.ctb to directory. Every table
+     * a capture or promotion leads to must already be in tablebases.
+     * @param log - receives progress lines, may be null
+     */
+    static bool generate(const std::string &signature, const std::string &directory, const Tablebases &tablebases,
+                         unsigned threads, void (*log)(const std::string&) = nullptr);
+    // Canonical names of the tables a capture or promotion in signature's material leads to
+    static std::vector<std::string> subtables(const std::string &signature);
+    // Canonical form of a material signature: stronger side first, pieces in QRBNP order. Empty if invalid
+    static std::string normalize(const std::string &signature);
+};
+
+#endif //EXAMAUTUMN2023_TABLEBASE_H
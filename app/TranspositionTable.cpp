@@ -0,0 +1,261 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#endif
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+#if defined(__linux__)
+    /**
+     * Bytes of the mappings overlapping [start, start + bytes) that the kernel backs with
+     * transparent huge pages, from their AnonHugePages lines in /proc/self/smaps. A successful
+     * madvise does not say this: THP may be off, or the range not suitably aligned
+     */
+    size_t anonHugePageBytes(const void* start, size_t bytes) {
+        FILE* smaps = fopen("/proc/self/smaps", "r");
+        if (!smaps) {
+            return 0;
+        }
+        uintptr_t first = reinterpret_cast<uintptr_t>(start);
+        uintptr_t last = first + bytes;
+        size_t total = 0;
+        bool overlaps = false;
+        char line[256];
+        while (fgets(line, sizeof(line), smaps)) {
+            unsigned long from, to;
+            size_t kb;
+            // Mapping lines start with "from-to", the lines after them describe that mapping
+            if (sscanf(line, "%lx-%lx ", &from, &to) == 2) {
+                overlaps = from < last && to > first;
+            } else if (overlaps && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+                total += kb << 10;
+            }
+        }
+        fclose(smaps);
+        return total;
+    }
+#endif
+
+    // Data word layout: move 0-15, score 16-31, eval 32-47, depth 48-55, bound 56-57, generation 58-63
+    uint64_t pack(Move move, int score, int eval, int depth, Bound bound, uint8_t generation) {
+        return (uint64_t) move
+             | (uint64_t) (uint16_t) score << 16
+             | (uint64_t) (uint16_t) eval << 32
+             | (uint64_t) (uint8_t) depth << 48
+             | (uint64_t) bound << 56
+             | (uint64_t) generation << 58;
+    }
+
+    TTData unpack(uint64_t data) {
+        TTData out;
+        out.move = (Move) data;
+        out.score = (int16_t) (data >> 16);
+        out.eval = (int16_t) (data >> 32);
+        out.depth = (int8_t) (data >> 48);
+        out.bound = (Bound) ((data >> 56) & 3);
+        return out;
+    }
+
+    uint8_t generationOf(uint64_t data) {
+        return (uint8_t) (data >> 58);
+    }
+
+    // High 64 bits of a 64x64 multiplication, maps a key uniformly onto [0, n)
+    uint64_t mulHi64(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+        return (uint64_t) (((unsigned __int128) a * b) >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        return __umulh(a, b);
+#else
+        uint64_t aLo = (uint32_t) a, aHi = a >> 32, bLo = (uint32_t) b, bHi = b >> 32;
+        uint64_t mid = aHi * bLo + ((aLo * bLo) >> 32);
+        return aHi * bHi + (mid >> 32) + ((aLo * bHi + (uint32_t) mid) >> 32);
+#endif
+    }
+
+    constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+}
+
+TranspositionTable::TranspositionTable(size_t sizeMB) {
+    resize(sizeMB);
+}
+
+TranspositionTable::~TranspositionTable() {
+    release();
+}
+
+void TranspositionTable::release() {
+    if (buckets) {
+#if defined(_WIN32)
+        _aligned_free(buckets);
+#else
+        free(buckets);
+#endif
+    }
+    buckets = nullptr;
+    bucketCount = 0;
+    allocatedBytes = 0;
+    hugePages = false;
+}
+
+void TranspositionTable::resize(size_t sizeMB) {
+    release();
+    size_t bytes = std::max<size_t>(sizeMB, 1) << 20;
+    // Round up to whole huge pages so the kernel can back all of it with them
+    bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+    void* memory = nullptr;
+#if defined(_WIN32)
+    memory = _aligned_malloc(bytes, 64);
+#else
+    if (posix_memalign(&memory, HUGE_PAGE_SIZE, bytes) != 0) {
+        memory = nullptr;
+    }
+#endif
+    if (!memory) {
+        return;
+    }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // Transparent huge pages cut TLB misses on random probes into a big table
+    bool requested = madvise(memory, bytes, MADV_HUGEPAGE) == 0;
+#endif
+
+    buckets = static_cast<Bucket*>(memory);
+    bucketCount = bytes / sizeof(Bucket);
+    allocatedBytes = bytes;
+    clear();
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // Clearing faulted every page in, so the kernel has decided by now which ones are huge
+    hugePages = requested && anonHugePageBytes(memory, bytes) > 0;
+#endif
+}
+
+void TranspositionTable::clear(unsigned threads) {
+    if (!buckets) {
+        return;
+    }
+    generation = 0;
+    threads = std::max(1u, threads);
+    size_t chunk = (bucketCount + threads - 1) / threads;
+    auto clearRange = [this, chunk](unsigned index) {
+        size_t start = std::min(bucketCount, chunk * index);
+        size_t end = std::min(bucketCount, start + chunk);
+        memset(static_cast<void*>(buckets + start), 0, (end - start) * sizeof(Bucket));
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; i++) {
+        workers.emplace_back(clearRange, i);
+    }
+    clearRange(0);
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+TranspositionTable::Bucket* TranspositionTable::bucketFor(uint64_t key) const {
+    return &buckets[mulHi64(key, bucketCount)];
+}
+
+void TranspositionTable::prefetch(uint64_t key) const {
+    if (!buckets) {
+        return;
+    }
+#if defined(_MSC_VER)
+    _mm_prefetch(reinterpret_cast<const char*>(bucketFor(key)), _MM_HINT_T0);
+#else
+    __builtin_prefetch(bucketFor(key));
+#endif
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData &out) const {
+    if (!buckets) {
+        return false;
+    }
+    Bucket* bucket = bucketFor(key);
+    for (auto &entry : bucket->entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.keyXorData.load(std::memory_order_relaxed);
+        if ((check ^ data) == key && ((data >> 56) & 3) != BOUND_NONE) {
+            out = unpack(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int eval, int depth, Bound bound) {
+    if (!buckets) {
+        return;
+    }
+    Bucket* bucket = bucketFor(key);
+    Entry* replace = nullptr;
+    int worstValue = 1 << 30;
+
+    for (auto &entry : bucket->entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.keyXorData.load(std::memory_order_relaxed);
+
+        // Same position: refresh it, but keep a deeper non-exact result and the old best move
+        if ((check ^ data) == key) {
+            TTData old = unpack(data);
+            if (bound != BOUND_EXACT && old.bound != BOUND_NONE && old.depth > depth + 2
+                && generationOf(data) == generation) {
+                return;
+            }
+            if (move == NO_MOVE) {
+                move = old.move;
+            }
+            replace = &entry;
+            break;
+        }
+
+        // Otherwise evict the shallowest entry, counting each search of age as 8 plies of depth
+        int value = ((data >> 56) & 3) == BOUND_NONE
+                    ? -(1 << 20)
+                    : unpack(data).depth - 8 * ((64 + generation - generationOf(data)) & 0x3F);
+        if (value < worstValue) {
+            worstValue = value;
+            replace = &entry;
+        }
+    }
+
+    uint64_t data = pack(move, score, eval, depth, bound, generation);
+    replace->data.store(data, std::memory_order_relaxed);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    if (!buckets) {
+        return 0;
+    }
+    size_t sample = std::min<size_t>(250, bucketCount);
+    int used = 0;
+    for (size_t i = 0; i < sample; i++) {
+        for (auto &entry : buckets[i].entries) {
+            uint64_t data = entry.data.load(std::memory_order_relaxed);
+            if (((data >> 56) & 3) != BOUND_NONE && generationOf(data) == generation) {
+                used++;
+            }
+        }
+    }
+    return (int) (used * 1000 / (sample * 4));
+}
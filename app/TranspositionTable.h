@@ -0,0 +1,83 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_TRANSPOSITIONTABLE_H
+#define EXAMAUTUMN2023_TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Move.h"
+
+enum Bound : uint8_t {
+    BOUND_NONE = 0,
+    BOUND_UPPER = 1,    // Score is at most this (fail low)
+    BOUND_LOWER = 2,    // Score is at least this (fail high)
+    BOUND_EXACT = 3
+};
+
+// What a probe hands back to the search
+struct TTData {
+    Move move;
+    int16_t score;
+    int16_t eval;
+    int8_t depth;
+    Bound bound;
+};
+
+/**
+ * Fixed-size hash table shared by all search threads without locks.
+ *
+ * Each entry is two 64-bit words: the packed data and key ^ data. A reader
+ * only accepts an entry if the XOR gives back its key, so a write torn by
+ * another thread is seen as a miss instead of as wrong data.
+ * Four entries make a 64-byte bucket, one cache line per probe.
+ */
+class TranspositionTable {
+private:
+    struct Entry {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket {
+        Entry entries[4];
+    };
+
+    Bucket* buckets = nullptr;
+    size_t bucketCount = 0;
+    size_t allocatedBytes = 0;
+    bool hugePages = false;     // Some of the table is backed by huge pages, as the kernel reports it
+    uint8_t generation = 0;     // Bumped by newSearch(), only the low 6 bits are stored in entries
+
+    Bucket* bucketFor(uint64_t key) const;
+    void release();
+public:
+    TranspositionTable() = default;
+    explicit TranspositionTable(size_t sizeMB);
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable &operator=(const TranspositionTable&) = delete;
+
+    // Reallocates the table with the given size and clears it. Not safe while a search runs
+    void resize(size_t sizeMB);
+    // Zeroes the table, splitting the work over threads for large tables
+    void clear(unsigned threads = 1);
+    // Call at the start of every search so older entries age and get replaced first
+    void newSearch() { generation = (generation + 1) & 0x3F; }
+
+    bool probe(uint64_t key, TTData &out) const;
+    void store(uint64_t key, Move move, int score, int eval, int depth, Bound bound);
+
+    // Starts loading the bucket for key into the cache ahead of the probe
+    void prefetch(uint64_t key) const;
+
+    // Permille of a sample of entries written during the current search
+    int hashfull() const;
+    size_t sizeMB() const { return allocatedBytes >> 20; }
+    // True only if the kernel actually backs the table with huge pages, not merely when they were asked for
+    bool usesHugePages() const { return hugePages; }
+};
+
+#endif //EXAMAUTUMN2023_TRANSPOSITIONTABLE_H
@@ -0,0 +1,236 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Uci.h"
+#include "Notation.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+    constexpr int DEFAULT_HASH_MB = 64;
+    constexpr int MAX_HASH_MB = 65536;
+    constexpr int MAX_THREADS = 512;
+
+    std::string scoreToUci(int score) {
+        if (score >= VALUE_MATE_IN_MAX_PLY) {
+            return "mate " + std::to_string((VALUE_MATE - score + 1) / 2);
+        }
+        if (score <= -VALUE_MATE_IN_MAX_PLY) {
+            return "mate -" + std::to_string((VALUE_MATE + score) / 2);
+        }
+        return "cp " + std::to_string(score);
+    }
+}
+
+Uci::Uci(std::ostream &out) : tt(DEFAULT_HASH_MB), search(tt), out(out) {
+    position.setStartPosition();
+    search.setReportCallback([this](const SearchReport &report) {
+        std::ostringstream line;
+        line << "info depth " << report.depth
+             << " seldepth " << report.selDepth
+             << " score " << scoreToUci(report.score)
+             << " nodes " << report.nodes
+             << " nps " << report.nps
+             << " hashfull " << report.hashfull
+             << " tbhits " << report.tbHits
+             << " time " << report.timeMs
+             << " pv";
+        for (int i = 0; i < report.pvLength; i++) {
+            line << ' ' << moveToUci(report.pv[i]);
+        }
+        send(line.str());
+    });
+}
+
+Uci::~Uci() {
+    stopSearch();
+}
+
+void Uci::send(const std::string &line) {
+    std::lock_guard<std::mutex> lock(outMutex);
+    out << line << std::endl;
+}
+
+void Uci::stopSearch() {
+    search.stop();
+    if (searchThread.joinable()) {
+        searchThread.join();
+    }
+}
+
+void Uci::loop(std::istream &in) {
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream args(line);
+        std::string command;
+        args >> command;
+
+        if (command == "uci") {
+            handleUci();
+        } else if (command == "isready") {
+            send("readyok");
+        } else if (command == "setoption") {
+            stopSearch();
+            handleSetOption(args);
+        } else if (command == "ucinewgame") {
+            stopSearch();
+            tt.clear(search.threadCount());
+        } else if (command == "position") {
+            stopSearch();
+            handlePosition(args);
+        } else if (command == "go") {
+            stopSearch();
+            handleGo(args);
+        } else if (command == "stop") {
+            stopSearch();
+        } else if (command == "ponderhit") {
+            search.ponderHit();
+        } else if (command == "quit") {
+            break;
+        }
+        // Unknown commands are ignored, as the protocol asks
+    }
+    stopSearch();
+}
+
+void Uci::handleUci() {
+    send("id name ChessSim");
+    send("id author larsm");
+    send("option name Hash type spin default " + std::to_string(DEFAULT_HASH_MB)
+         + " min 1 max " + std::to_string(MAX_HASH_MB));
+    send("option name Threads type spin default 1 min 1 max " + std::to_string(MAX_THREADS));
+    send("option name Ponder type check default false");
+    send("option name Clear Hash type button");
+    send("option name EvalFile type string default <empty>");
+    send("option name TablebasePath type string default <empty>");
+    send("option name OwnBook type check default false");
+    send("option name BookFile type string default <empty>");
+    send("uciok");
+}
+
+void Uci::handleSetOption(std::istringstream &args) {
+    // setoption name <name, may contain spaces> [value <value>]
+    std::string token, name, value;
+    args >> token;
+    while (args >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    while (args >> token) {
+        value += (value.empty() ? "" : " ") + token;
+    }
+
+    if (name == "Hash") {
+        tt.resize((size_t) std::clamp(atoi(value.c_str()), 1, MAX_HASH_MB));
+    } else if (name == "Threads") {
+        search.setThreads((unsigned) std::clamp(atoi(value.c_str()), 1, MAX_THREADS));
+    } else if (name == "Clear Hash") {
+        tt.clear(search.threadCount());
+    } else if (name == "EvalFile") {
+        search.setNetwork(nullptr);
+        if (value.empty() || value == "<empty>") {
+            send("info string classical evaluation");
+        } else if (network.load(value)) {
+            search.setNetwork(&network);
+            send("info string NNUE evaluation from " + value + " using " + Nnue::kernelName());
+        } else {
+            send("info string could not load network " + value + ", classical evaluation");
+        }
+    } else if (name == "OwnBook") {
+        ownBook = value == "true";
+    } else if (name == "BookFile") {
+        book.close();
+        if (!value.empty() && value != "<empty>") {
+            send(book.open(value) ? "info string " + std::to_string(book.size()) + " book entries in " + value
+                                  : "info string could not open book: " + book.lastError());
+        }
+    } else if (name == "TablebasePath") {
+        search.setTablebases(nullptr);
+        int found = value.empty() || value == "<empty>" ? 0 : tablebases.init(value);
+        if (found > 0) {
+            search.setTablebases(&tablebases);
+            send("info string " + std::to_string(found) + " tablebases up to "
+                 + std::to_string(tablebases.maxPieces()) + " pieces in " + value);
+        } else {
+            tablebases.clear();
+            send("info string no tablebases");
+        }
+    }
+}
+
+void Uci::handlePosition(std::istringstream &args) {
+    // position startpos | fen <fen> [moves <move> ...]
+    std::string token;
+    args >> token;
+    if (token == "startpos") {
+        position.setStartPosition();
+        args >> token;
+    } else if (token == "fen") {
+        std::string fen;
+        while (args >> token && token != "moves") {
+            fen += (fen.empty() ? "" : " ") + token;
+        }
+        if (!position.setFromFen(fen)) {
+            send("info string invalid fen, using the start position");
+            position.setStartPosition();
+        }
+    } else {
+        return;
+    }
+    gameKeys.clear();
+
+    if (token != "moves") {
+        return;
+    }
+    while (args >> token) {
+        Move m = parseUciMove(position, token);
+        if (m == NO_MOVE) {
+            send("info string illegal move " + token);
+            break;
+        }
+        gameKeys.push_back(position.hash());
+        UndoRecord undo;
+        position.makeMove(m, undo);
+    }
+}
+
+void Uci::handleGo(std::istringstream &args) {
+    SearchLimits limits;
+    std::string token;
+    while (args >> token) {
+        if (token == "wtime") args >> limits.time[WHITE];
+        else if (token == "btime") args >> limits.time[BLACK];
+        else if (token == "winc") args >> limits.increment[WHITE];
+        else if (token == "binc") args >> limits.increment[BLACK];
+        else if (token == "movestogo") args >> limits.movesToGo;
+        else if (token == "depth") args >> limits.depth;
+        else if (token == "nodes") args >> limits.nodes;
+        else if (token == "movetime") args >> limits.moveTime;
+        else if (token == "infinite") limits.infinite = true;
+        else if (token == "ponder") limits.ponder = true;
+    }
+
+    // A book move is played without searching. Analysis and pondering always search
+    if (ownBook && !limits.infinite && !limits.ponder) {
+        Move bookMove = book.pick(position, bookRandom());
+        if (bookMove != NO_MOVE) {
+            send("info string book move");
+            send("bestmove " + moveToUci(bookMove));
+            return;
+        }
+    }
+
+    // The search thread gets its own copies, the next "position" may arrive while it runs
+    Position root = position;
+    std::vector<uint64_t> keys = gameKeys;
+    searchThread = std::thread([this, root, keys, limits] {
+        SearchResult result = search.think(root, keys, limits);
+        if (result.bestMove == NO_MOVE) {
+            send("bestmove 0000");
+        } else if (result.ponderMove != NO_MOVE) {
+            send("bestmove " + moveToUci(result.bestMove) + " ponder " + moveToUci(result.ponderMove));
+        } else {
+            send("bestmove " + moveToUci(result.bestMove));
+        }
+    });
+}
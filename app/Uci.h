@@ -0,0 +1,60 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_UCI_H
+#define EXAMAUTUMN2023_UCI_H
+
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Book.h"
+#include "Nnue.h"
+#include "Position.h"
+#include "Search.h"
+#include "Tablebase.h"
+#include "TranspositionTable.h"
+
+/**
+ * Universal Chess Interface front-end. Commands are read on the calling
+ * thread while the search runs on its own thread, so "stop" and "isready"
+ * are answered at once even in the middle of a search.
+ */
+class Uci {
+private:
+    Position position;
+    std::vector<uint64_t> gameKeys;     // Positions before the current one, for repetition detection
+    TranspositionTable tt;
+    Nnue::Network network;              // Loaded through the EvalFile option, classical evaluation until then
+    Tablebases tablebases;              // Files in the TablebasePath directory
+    OpeningBook book;                   // BookFile, played from only with OwnBook on
+    bool ownBook = false;
+    std::mt19937_64 bookRandom{std::random_device{}()};
+    Search search;
+    std::thread searchThread;
+
+    std::ostream &out;
+    std::mutex outMutex;                // Search reports and command replies come from different threads
+
+    // Writes and flushes one line; the GUI reads replies line by line
+    void send(const std::string &line);
+    void stopSearch();
+
+    void handleUci();
+    void handleSetOption(std::istringstream &args);
+    void handlePosition(std::istringstream &args);
+    void handleGo(std::istringstream &args);
+
+public:
+    explicit Uci(std::ostream &out = std::cout);
+    ~Uci();
+
+    // Reads commands from in until "quit" or end of input
+    void loop(std::istream &in = std::cin);
+};
+
+#endif //EXAMAUTUMN2023_UCI_H
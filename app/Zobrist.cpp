@@ -0,0 +1,43 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include "Zobrist.h"
+
+uint64_t Zobrist::PieceKeys[12][64];
+uint64_t Zobrist::CastlingKeys[16];
+uint64_t Zobrist::EnPassantKeys[8];
+uint64_t Zobrist::SideKey;
+
+// Fixed seed, so keys (and anything stored under them) are the same on every run
+static void generateKeys() {
+    uint64_t state = 1070372;
+    auto next = [&state]() {
+        return Zobrist::splitMix64(state);
+    };
+
+    for (auto &pieceKeys : Zobrist::PieceKeys) {
+        for (auto &key : pieceKeys) {
+            key = next();
+        }
+    }
+    // Castling rights combine, so a right set's key is the XOR of its single rights
+    uint64_t rightKeys[4] = {next(), next(), next(), next()};
+    for (int rights = 0; rights < 16; rights++) {
+        Zobrist::CastlingKeys[rights] = 0;
+        for (int i = 0; i < 4; i++) {
+            if (rights & (1 << i)) {
+                Zobrist::CastlingKeys[rights] ^= rightKeys[i];
+            }
+        }
+    }
+    for (auto &key : Zobrist::EnPassantKeys) {
+        key = next();
+    }
+    Zobrist::SideKey = next();
+}
+
+void Zobrist::init() {
+    static const bool initialized = (generateKeys(), true);
+    (void) initialized;
+}
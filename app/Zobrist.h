@@ -0,0 +1,32 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#ifndef EXAMAUTUMN2023_ZOBRIST_H
+#define EXAMAUTUMN2023_ZOBRIST_H
+
+#include <cstdint>
+
+/**
+ * Random keys for Zobrist hashing. A position's key is the XOR of the keys of
+ * everything in it, so a move updates it with a handful of XORs.
+ * init() must be called before the keys are used; Position's constructor does it.
+ */
+namespace Zobrist {
+    extern uint64_t PieceKeys[12][64];
+    extern uint64_t CastlingKeys[16];
+    extern uint64_t EnPassantKeys[8];   // Indexed by file
+    extern uint64_t SideKey;            // XORed in when black is to move
+
+    void init();
+
+    // splitmix64: the next number of a fast 64-bit generator whose whole state is one integer
+    inline uint64_t splitMix64(uint64_t &state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+}
+
+#endif //EXAMAUTUMN2023_ZOBRIST_H
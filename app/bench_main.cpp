@@ -0,0 +1,198 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MoveGen.h"
+#include "Nnue.h"
+#include "Position.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+// Middlegame and endgame positions that exercise the search rather than the opening book
+static const char* BENCH_FENS[] = {
+        START_FEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "6k1/5pp1/7p/8/3R4/6P1/5PKP/2r5 b - - 0 40",
+        "8/8/4kpp1/3p4/p2P1P2/P3K1P1/8/8 w - - 0 50",
+};
+
+static void printUsage() {
+    printf("Usage: chess-bench [options]\n"
+           "  --depth <n>      Depth searched in every position (default 10)\n"
+           "  --threads <n>    Highest thread count to measure (default: all cores)\n"
+           "  --hash <mb>      Transposition table size (default 64)\n"
+           "  --nnue <file>    Measure the network's evals/s per kernel, then search with it\n"
+           "  --nnue-random <file>  Same with a freshly written network of random weights\n");
+}
+
+struct BenchRun {
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+};
+
+// Searches every bench position to a fixed depth from an empty table
+static BenchRun runBench(TranspositionTable &tt, unsigned threads, int depth, const Nnue::Network* network) {
+    Search search(tt, threads);
+    search.setNetwork(network);
+    SearchLimits limits;
+    limits.depth = depth;
+    BenchRun run;
+    for (auto fen : BENCH_FENS) {
+        Position pos;
+        pos.setFromFen(fen);
+        tt.clear(threads);
+        SearchResult result = search.think(pos, {}, limits);
+        run.nodes += result.nodes;
+        run.timeMs += result.timeMs;
+    }
+    return run;
+}
+
+/**
+ * Plays random games from the bench positions and evaluates every position
+ * along them, once refreshing the accumulator from scratch and once updating
+ * it from the previous ply as the search does. Both include making the move.
+ * Every kernel the CPU supports is timed and must give the same scores.
+ */
+static void benchNnue(const Nnue::Network &network) {
+    std::vector<std::vector<Move>> games;
+    std::mt19937 random(2026);
+    for (int i = 0; i < 64; i++) {
+        Position pos;
+        pos.setFromFen(BENCH_FENS[i % (sizeof(BENCH_FENS) / sizeof(BENCH_FENS[0]))]);
+        games.emplace_back();
+        UndoRecord undo;
+        for (int ply = 0; ply < 100; ply++) {
+            MoveList moves;
+            generateLegalMoves(pos, moves);
+            if (moves.size() == 0) {
+                break;
+            }
+            Move m = moves.moves[random() % moves.size()];
+            pos.makeMove(m, undo);
+            games.back().push_back(m);
+        }
+    }
+
+    printf("NNUE: %d features, %d x 2 -> %d -> %d -> 1\n", Nnue::FEATURES, Nnue::HIDDEN, Nnue::L1, Nnue::L2);
+    printf("%8s %14s %14s %10s\n", "kernel", "refresh e/s", "update e/s", "speedup");
+    int64_t expected = 0;
+    for (const char* kernel : {"scalar", "sse2", "avx2", "neon"}) {
+        if (!Nnue::selectKernels(kernel)) {
+            continue;
+        }
+        double rates[2];
+        int64_t checksums[2] = {0, 0};
+        for (int incremental = 0; incremental < 2; incremental++) {
+            // Repeat the games until the timing is long enough to mean something
+            uint64_t evals = 0;
+            auto start = std::chrono::steady_clock::now();
+            double seconds = 0;
+            for (int round = 0; round == 0 || seconds < 0.5; round++) {
+                for (auto &game : games) {
+                    Position pos;
+                    pos.setFromFen(BENCH_FENS[(&game - &games[0]) % (sizeof(BENCH_FENS) / sizeof(BENCH_FENS[0]))]);
+                    Nnue::Accumulator acc[2];
+                    network.refresh(acc[0], pos);
+                    UndoRecord undo;
+                    for (size_t ply = 0; ply < game.size(); ply++) {
+                        pos.makeMove(game[ply], undo);
+                        Nnue::Accumulator &next = acc[(ply + 1) & 1];
+                        if (incremental) {
+                            network.update(acc[ply & 1], next, pos, game[ply], undo);
+                        } else {
+                            network.refresh(next, pos);
+                        }
+                        int score = network.evaluate(next, pos.sideToMove());
+                        if (round == 0) {
+                            checksums[incremental] += score * (int64_t) (ply + 1);
+                        }
+                        evals++;
+                    }
+                }
+                seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+            rates[incremental] = evals / seconds;
+        }
+        printf("%8s %14.0f %14.0f %10.2f%s\n", kernel, rates[0], rates[1], rates[1] / rates[0],
+               checksums[0] != checksums[1] || (expected && checksums[0] != expected) ? "  MISMATCH" : "");
+        expected = checksums[0];
+    }
+    Nnue::selectKernels("auto");
+    printf("Searching with NNUE, %s kernels\n", Nnue::kernelName());
+}
+
+int main(int argc, char* argv[]) {
+    int depth = 10;
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t hashMB = 64;
+    std::string networkPath;
+    bool randomNetwork = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--depth") && i + 1 < argc) {
+            depth = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            maxThreads = (unsigned) std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--hash") && i + 1 < argc) {
+            hashMB = (size_t) atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--nnue") && i + 1 < argc) {
+            networkPath = argv[++i];
+        } else if (!strcmp(argv[i], "--nnue-random") && i + 1 < argc) {
+            networkPath = argv[++i];
+            randomNetwork = true;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    Nnue::Network network;
+    if (randomNetwork && !Nnue::Network::writeRandom(networkPath, 1)) {
+        fprintf(stderr, "Could not write %s\n", networkPath.c_str());
+        return 1;
+    }
+    if (!networkPath.empty()) {
+        if (!network.load(networkPath)) {
+            fprintf(stderr, "Could not load network %s\n", networkPath.c_str());
+            return 1;
+        }
+        benchNnue(network);
+    }
+
+    TranspositionTable tt(hashMB);
+    printf("Bench: %zu positions, depth %d, hash %zu MB%s\n", sizeof(BENCH_FENS) / sizeof(BENCH_FENS[0]), depth,
+           tt.sizeMB(), tt.usesHugePages() ? " (huge pages)" : "");
+    printf("%8s %14s %10s %12s %10s %10s\n", "threads", "nodes", "time ms", "knps", "nps x", "ttd x");
+
+    // Lazy SMP gains show up as time to depth, raw nodes/s alone overstates them
+    BenchRun single;
+    for (unsigned threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        BenchRun run = runBench(tt, threads, depth, network.isLoaded() ? &network : nullptr);
+        if (threads == 1) {
+            single = run;
+        }
+        double nps = run.timeMs > 0 ? run.nodes * 1000.0 / run.timeMs : 0.0;
+        double singleNps = single.timeMs > 0 ? single.nodes * 1000.0 / single.timeMs : 0.0;
+        printf("%8u %14llu %10lld %12.0f %10.2f %10.2f\n", threads, (unsigned long long) run.nodes,
+               (long long) run.timeMs, nps / 1000, singleNps > 0 ? nps / singleNps : 0.0,
+               run.timeMs > 0 ? (double) single.timeMs / run.timeMs : 0.0);
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Book.h"
+#include "MoveGen.h"
+#include "PackedFormat.h"
+#include "Position.h"
+
+static void printUsage() {
+    printf("Usage: chess-book --out <book> [options] <games.cgf> ...\n"
+           "       chess-book --probe <book> [--fen <fen>]\n"
+           "  --out <file>        Build a book from packed game files (chess-ingest --pack, chess-selfplay)\n"
+           "  --plies <n>         Plies of every game that go into the book (default 20)\n"
+           "  --min-weight <n>    Drop moves with a lower total weight (default 2)\n"
+           "  --probe <file>      Print the book moves of a position (default: the start position)\n"
+           "  --fen <fen>         Position to probe\n");
+}
+
+/**
+ * Polyglot's weighting: a move scores 2 for every game the side that played it went on to win
+ * and 1 for every draw, so moves that lose disappear from the book.
+ */
+static int buildBook(const std::vector<std::string> &inputs, const std::string &out, int plies, uint64_t minWeight) {
+    auto start = std::chrono::steady_clock::now();
+    BookWriter writer;
+    uint64_t games = 0;
+    for (const std::string &input : inputs) {
+        GameReader reader;
+        if (!reader.open(input, MappedFile::SEQUENTIAL)) {
+            fprintf(stderr, "Could not read %s\n", input.c_str());
+            return 1;
+        }
+        for (size_t i = 0; i < reader.size(); i++) {
+            GameView game;
+            Position pos;
+            if (!reader.game(i, game) || !unpackPosition(game.header->start, pos)) {
+                continue;
+            }
+            games++;
+            UndoRecord undo;
+            for (int ply = 0; ply < std::min(plies, game.moveCount()); ply++) {
+                Move m = game.moves[ply];
+                // A damaged or foreign file may hold moves that are not legal here, the rest of such a game is skipped
+                MoveList legal;
+                generateLegalMoves(pos, legal);
+                if (!legal.contains(m)) {
+                    break;
+                }
+                GameResult result = game.result();
+                uint64_t weight = result == DRAW || result == UNKNOWN_RESULT ? 1
+                                  : ((result == WHITE_WINS) == (pos.sideToMove() == WHITE) ? 2 : 0);
+                writer.add(pos, m, weight);
+                pos.makeMove(m, undo);
+            }
+        }
+    }
+    size_t moves = writer.size();
+    long long entries = writer.write(out, minWeight);
+    if (entries < 0) {
+        fprintf(stderr, "Could not write %s\n", out.c_str());
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%llu games, %zu book moves -> %lld entries in %s (%.1f s)\n", (unsigned long long) games, moves,
+           entries, out.c_str(), seconds);
+    return 0;
+}
+
+static int probeBook(const std::string &path, const std::string &fen) {
+    OpeningBook book;
+    if (!book.open(path)) {
+        fprintf(stderr, "Could not open book: %s\n", book.lastError().c_str());
+        return 1;
+    }
+    Position pos;
+    if (!pos.setFromFen(fen)) {
+        fprintf(stderr, "Invalid FEN: %s\n", fen.c_str());
+        return 2;
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BookMove> moves;
+    book.probe(pos, moves);
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    int total = 0;
+    for (const BookMove &bookMove : moves) {
+        total += bookMove.weight;
+    }
+    printf("%zu entries, %zu moves for this position (%.1f us)\n", book.size(), moves.size(), micros);
+    for (const BookMove &bookMove : moves) {
+        printf("  %-6s %6d  %5.1f%%\n", moveToUci(bookMove.move).c_str(), bookMove.weight,
+               100.0 * bookMove.weight / total);
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string out, probe;
+    std::string fen = START_FEN;
+    int plies = 20;
+    uint64_t minWeight = 2;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--out") && i + 1 < argc) {
+            out = argv[++i];
+        } else if (!strcmp(argv[i], "--plies") && i + 1 < argc) {
+            plies = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--min-weight") && i + 1 < argc) {
+            minWeight = (uint64_t) std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--probe") && i + 1 < argc) {
+            probe = argv[++i];
+        } else if (!strcmp(argv[i], "--fen") && i + 1 < argc) {
+            fen = argv[++i];
+        } else if (argv[i][0] != '-') {
+            inputs.push_back(argv[i]);
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (!probe.empty()) {
+        return probeBook(probe, fen);
+    }
+    if (out.empty() || inputs.empty()) {
+        printUsage();
+        return 2;
+    }
+    return buildBook(inputs, out, plies, minWeight);
+}
@@ -0,0 +1,232 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "BoundedQueue.h"
+#include "ChessEngine.h"
+#include "MappedFile.h"
+#include "PackedFormat.h"
+#include "Pgn.h"
+
+// What one worker found in one chunk, merged into the totals by the main thread
+struct ChunkStats {
+    uint64_t bytes = 0;
+    uint64_t games = 0;
+    uint64_t positions = 0;
+    uint64_t rejects = 0;       // Games with an illegal or unreadable move
+    uint64_t unpacked = 0;      // Accepted games too long for the engine's move history, left out of --pack
+    std::unordered_map<std::string, uint64_t> openings;
+    // Accepted games for --pack: start positions, their move counts and all moves back to back
+    std::vector<PackedPosition> starts;
+    std::vector<int> moveCounts;
+    std::vector<Move> moves;
+};
+
+static void printUsage() {
+    printf("Usage: chess-ingest <file.pgn> [options]\n"
+           "  --threads <n>    Worker threads (default: all cores)\n"
+           "  --chunk-mb <n>   Bytes of PGN handed to a worker at a time (default 4)\n"
+           "  --opening <n>    Plies that name an opening when a game has no ECO tag (default 6)\n"
+           "  --top <n>        Openings to list (default 10)\n"
+           "  --pack <file>    Also write the accepted games to a packed game file, in no fixed order\n");
+}
+
+// ECO code if the game has one, otherwise its first plies
+static std::string openingKey(const PgnGame &game, int plies) {
+    std::string_view eco = game.tag("ECO");
+    if (!eco.empty() && eco != "?") {
+        return std::string(eco);
+    }
+    std::string key;
+    PgnMoveTokens tokens(game.movetext);
+    std::string_view san;
+    for (int i = 0; i < plies && tokens.next(san); i++) {
+        if (!key.empty()) {
+            key += ' ';
+        }
+        key += san;
+    }
+    return key;
+}
+
+// Parses, validates and replays every game of a chunk through the engine
+static void ingestChunk(std::string_view text, ChessEngine &engine, int openingPlies, bool pack, ChunkStats &stats) {
+    stats.bytes = text.size();
+    PgnReader reader(text);
+    PgnGame game;
+    while (reader.next(game)) {
+        stats.games++;
+        if (!engine.loadGame(game)) {
+            stats.rejects++;
+            continue;
+        }
+        stats.positions += engine.getMoveCount();
+        stats.openings[openingKey(game, openingPlies)]++;
+        if (pack) {
+            // playMove starts the history over when it is full, so it only holds every move of shorter games
+            const MoveHistory &history = engine.getHistory();
+            if (history.size() != engine.getMoveCount()) {
+                stats.unpacked++;
+                continue;
+            }
+            // loadGame accepted the FEN, so parsing it again cannot fail
+            Position start;
+            std::string_view fen = game.tag("FEN");
+            start.setFromFen(fen.empty() ? std::string(START_FEN) : std::string(fen));
+            stats.starts.push_back(packPosition(start, 0, parseResult(game.tag("Result"))));
+            stats.moveCounts.push_back(history.size());
+            for (int i = 0; i < history.size(); i++) {
+                stats.moves.push_back(history.move(i));
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkBytes = 4 << 20;
+    int openingPlies = 6;
+    size_t top = 10;
+    std::string packPath;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = (unsigned) std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--chunk-mb") && i + 1 < argc) {
+            chunkBytes = (size_t) std::max(1, atoi(argv[++i])) << 20;
+        } else if (!strcmp(argv[i], "--opening") && i + 1 < argc) {
+            openingPlies = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--top") && i + 1 < argc) {
+            top = (size_t) std::max(0, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--pack") && i + 1 < argc) {
+            packPath = argv[++i];
+        } else if (argv[i][0] != '-' && path.empty()) {
+            path = argv[i];
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (path.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    MappedFile file;
+    if (!file.open(path, MappedFile::SEQUENTIAL)) {
+        fprintf(stderr, "Could not open %s\n", path.c_str());
+        return 1;
+    }
+    std::string_view text = file.view();
+    GameWriter packed;
+    if (!packPath.empty() && !packed.open(packPath)) {
+        fprintf(stderr, "Could not create %s\n", packPath.c_str());
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    // splitter -> chunks -> workers -> results -> main thread. Both queues are bounded, so
+    // the splitter only runs a few chunks ahead and memory stays flat however big the file is
+    BoundedQueue<std::string_view> chunks(threads * 2);
+    BoundedQueue<ChunkStats> results(threads * 2);
+
+    std::thread splitter([&] {
+        size_t offset = 0;
+        while (offset < text.size()) {
+            size_t end = offset + chunkBytes >= text.size() ? text.size() : findGameStart(text, offset + chunkBytes);
+            chunks.push(text.substr(offset, end - offset));
+            offset = end;
+        }
+        chunks.close();
+    });
+
+    std::atomic<unsigned> running{threads};
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back([&] {
+            // Each worker has its own engine, nothing is shared but the queues
+            ChessEngine engine("", false);
+            std::string_view chunk;
+            while (chunks.pop(chunk)) {
+                ChunkStats stats;
+                ingestChunk(chunk, engine, openingPlies, !packPath.empty(), stats);
+                results.push(std::move(stats));
+            }
+            if (--running == 0) {
+                results.close();
+            }
+        });
+    }
+
+    ChunkStats total;
+    ChunkStats stats;
+    auto lastReport = start;
+    while (results.pop(stats)) {
+        total.bytes += stats.bytes;
+        total.games += stats.games;
+        total.positions += stats.positions;
+        total.rejects += stats.rejects;
+        total.unpacked += stats.unpacked;
+        for (auto &opening : stats.openings) {
+            total.openings[opening.first] += opening.second;
+        }
+        const Move* moves = stats.moves.data();
+        for (size_t i = 0; i < stats.starts.size(); i++) {
+            packed.addGame(stats.starts[i], moves, stats.moveCounts[i]);
+            moves += stats.moveCounts[i];
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= std::chrono::seconds(1)) {
+            double seconds = std::chrono::duration<double>(now - start).count();
+            printf("  %6.1f%%  %llu games  %.2f M positions/s\n", 100.0 * total.bytes / text.size(),
+                   (unsigned long long) total.games, total.positions / seconds / 1e6);
+            lastReport = now;
+        }
+    }
+    splitter.join();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%s: %.1f MB in %.2f s with %u threads\n", path.c_str(), text.size() / 1048576.0, seconds, threads);
+    printf("  games      %12llu  (%.0f/s)\n", (unsigned long long) total.games, total.games / seconds);
+    printf("  positions  %12llu  (%.2f M/s)\n", (unsigned long long) total.positions, total.positions / seconds / 1e6);
+    printf("  rejected   %12llu\n", (unsigned long long) total.rejects);
+    if (!packPath.empty()) {
+        uint64_t games = packed.written();
+        if (!packed.close()) {
+            fprintf(stderr, "Could not write %s\n", packPath.c_str());
+            return 1;
+        }
+        printf("  packed     %12llu  -> %s\n", (unsigned long long) games, packPath.c_str());
+        if (total.unpacked > 0) {
+            printf("  too long   %12llu  (not packed)\n", (unsigned long long) total.unpacked);
+        }
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> openings(total.openings.begin(), total.openings.end());
+    std::sort(openings.begin(), openings.end(), [](const auto &a, const auto &b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    if (top > 0 && !openings.empty()) {
+        printf("  openings:\n");
+    }
+    for (size_t i = 0; i < std::min(top, openings.size()); i++) {
+        printf("    %10llu  %s\n", (unsigned long long) openings[i].second, openings[i].first.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Perft.h"
+#include "Position.h"
+#include "ThreadPool.h"
+
+struct PerftCase {
+    const char* name;
+    const char* fen;
+    std::vector<uint64_t> nodes;    // Expected leaf count for depth 1, 2, ...
+    int defaultDepth;
+};
+
+// Reference counts from the Chess Programming Wiki "Perft Results" page
+static const PerftCase SUITE[] = {
+        {"startpos", START_FEN,
+                {20, 400, 8902, 197281, 4865609, 119060324}, 6},
+        {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                {48, 2039, 97862, 4085603, 193690690}, 5},
+        {"position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+                {14, 191, 2812, 43238, 674624, 11030083}, 6},
+        {"position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+                {6, 264, 9467, 422333, 15833292}, 5},
+        {"position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+                {44, 1486, 62379, 2103487, 89941194}, 5},
+        {"position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+                {46, 2079, 89890, 3894594, 164075551}, 5},
+};
+
+static void printUsage() {
+    printf("Usage: chess-perft [options]\n"
+           "  --fen <fen>      Position to count (default: run the reference suite)\n"
+           "  --depth <n>      Search depth (suite default: per position)\n"
+           "  --threads <n>    Split root moves over n worker threads (default 1)\n"
+           "  --divide         Print the leaf count below every root move\n");
+}
+
+// Runs one perft and prints nodes, time and speed. Returns the node count
+static uint64_t runPerft(const Position &pos, int depth, ThreadPool* pool) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = pool ? perftParallel(pos, depth, *pool) : perft(pos, depth);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("  depth %d: %12llu nodes %9.3f s %8.2f Mnps\n", depth, (unsigned long long) nodes, seconds,
+           seconds > 0 ? nodes / seconds / 1e6 : 0.0);
+    return nodes;
+}
+
+int main(int argc, char* argv[]) {
+    std::string fen;
+    int depth = 0;
+    unsigned threads = 1;
+    bool divide = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--fen") && i + 1 < argc) {
+            fen = argv[++i];
+        } else if (!strcmp(argv[i], "--depth") && i + 1 < argc) {
+            depth = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = (unsigned) atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--divide")) {
+            divide = true;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    ThreadPool* pool = threads > 1 ? new ThreadPool(threads) : nullptr;
+
+    // Single position
+    if (!fen.empty()) {
+        Position pos;
+        if (!pos.setFromFen(fen)) {
+            fprintf(stderr, "Invalid FEN: %s\n", fen.c_str());
+            delete pool;
+            return 2;
+        }
+        depth = depth > 0 ? depth : 5;
+        if (divide) {
+            uint64_t total = 0;
+            for (const auto &entry : perftDivide(pos, depth)) {
+                printf("%s: %llu\n", moveToUci(entry.first).c_str(), (unsigned long long) entry.second);
+                total += entry.second;
+            }
+            printf("\nNodes searched: %llu\n", (unsigned long long) total);
+        } else {
+            runPerft(pos, depth, pool);
+        }
+        delete pool;
+        return 0;
+    }
+
+    // Reference suite
+    int failures = 0;
+    uint64_t totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &test : SUITE) {
+        Position pos;
+        pos.setFromFen(test.fen);
+        int maxDepth = depth > 0 ? depth : test.defaultDepth;
+        if (maxDepth > (int) test.nodes.size()) {
+            maxDepth = (int) test.nodes.size();
+        }
+        printf("%s\n", test.name);
+        uint64_t nodes = runPerft(pos, maxDepth, pool);
+        totalNodes += nodes;
+        if (nodes != test.nodes[maxDepth - 1]) {
+            printf("  FAILED: expected %llu\n", (unsigned long long) test.nodes[maxDepth - 1]);
+            failures++;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("\n%s: %llu nodes in %.3f s (%.2f Mnps, %u thread%s)\n", failures ? "FAILED" : "OK",
+           (unsigned long long) totalNodes, seconds, seconds > 0 ? totalNodes / seconds / 1e6 : 0.0,
+           threads > 1 ? threads : 1, threads > 1 ? "s" : "");
+
+    delete pool;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,400 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Book.h"
+#include "ChessEngine.h"
+#include "MappedFile.h"
+#include "MoveGen.h"
+#include "PackedFormat.h"
+#include "Pgn.h"
+#include "Search.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+
+struct Options {
+    int games = 100;
+    unsigned concurrency = std::max(1u, std::thread::hardware_concurrency());
+    SearchLimits limits;
+    size_t hashMB = 16;
+    int randomPlies = 0;
+    int bookPlies = 16;
+    int maxPlies = 400;
+    int resignScore = 1000;     // Adjudicate a win once both sides agree on this margin...
+    int resignMoves = 4;        // ...for this many moves each in a row
+    int drawScore = 10;
+    int drawMoves = 8;
+    int drawAfter = 80;         // Draw adjudication only starts at this ply
+    uint64_t seed = 1;
+    const OpeningBook* openingBook = nullptr;  // Polyglot-style book the games start from, if any
+};
+
+// Start position of a game plus the book moves played from it
+struct Opening {
+    Position start;
+    std::vector<Move> moves;
+};
+
+enum Termination {
+    BOARD_END,          // Mate, stalemate, repetition or the fifty-move rule
+    ADJUDICATED_WIN,
+    ADJUDICATED_DRAW,
+    INSUFFICIENT_MATERIAL,
+    MAX_PLIES,
+    TERMINATION_COUNT
+};
+
+static const char* TERMINATION_NAMES[TERMINATION_COUNT] = {
+        "on the board", "win adjudication", "draw adjudication", "insufficient material", "ply limit"
+};
+
+struct GameRecord {
+    Position start;
+    std::vector<Move> moves;
+    GameResult result = UNKNOWN_RESULT;
+    Termination termination = BOARD_END;
+    // Positions the engine searched, quiet and not in check, scored from the side to move's view
+    std::vector<PackedPosition> positions;
+    uint64_t nodes = 0;
+};
+
+static void printUsage() {
+    printf("Usage: chess-selfplay [options]\n"
+           "  --games <n>          Games to play (default 100)\n"
+           "  --concurrency <n>    Games played at the same time (default: all cores)\n"
+           "  --nodes <n>          Nodes per move (default 20000 if no other limit is given)\n"
+           "  --movetime <ms>      Milliseconds per move\n"
+           "  --depth <n>          Depth per move\n"
+           "  --hash <mb>          Transposition table per game (default 16)\n"
+           "  --book <file>        Openings: one FEN or EPD per line, a .pgn file or a .bin book\n"
+           "  --book-plies <n>     Plies taken from each PGN book game or from the .bin book (default 16)\n"
+           "  --random-plies <n>   Random legal moves played after the opening (default 0)\n"
+           "  --max-plies <n>      Adjudicate a draw after this many plies (default 400)\n"
+           "  --resign <cp> <n>    Adjudicate a win when both sides score beyond cp for n moves (default 1000 4)\n"
+           "  --draw <cp> <n> <p>  Adjudicate a draw when both sides score within cp for n moves\n"
+           "                       after ply p (default 10 8 80)\n"
+           "  --seed <n>           Seed for the random plies (default 1)\n"
+           "  --games-out <file>   Write the games to a packed game file\n"
+           "  --positions-out <f>  Write the scored positions to a packed position file\n"
+           "  --pgn <file>         Write the games as PGN\n");
+}
+
+// Openings from a PGN database (first bookPlies of every game) or from FEN/EPD lines
+static bool loadBook(const std::string &path, int bookPlies, std::vector<Opening> &book) {
+    if (path.size() > 4 && path.compare(path.size() - 4, 4, ".pgn") == 0) {
+        MappedFile file;
+        if (!file.open(path, MappedFile::SEQUENTIAL)) {
+            return false;
+        }
+        PgnReader reader(file.view());
+        PgnGame game;
+        while (reader.next(game)) {
+            Opening opening;
+            Position pos;
+            int plies = 0;
+            int played = replayGame(game, pos, [&](const Position &before, Move m) {
+                if (plies++ == 0) {
+                    opening.start = before;
+                }
+                if ((int) opening.moves.size() < bookPlies) {
+                    opening.moves.push_back(m);
+                }
+            });
+            if (played > 0) {
+                book.push_back(std::move(opening));
+            }
+        }
+        return true;
+    }
+
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        Opening opening;
+        if (opening.start.setFromFen(line)) {
+            book.push_back(std::move(opening));
+        }
+    }
+    return true;
+}
+
+// Neither side can mate: bare kings, or one minor piece against a bare king
+static bool insufficientMaterial(const Position &pos) {
+    if (pos.pieces(WHITE, PAWN) | pos.pieces(BLACK, PAWN) | pos.pieces(WHITE, ROOK) | pos.pieces(BLACK, ROOK)
+        | pos.pieces(WHITE, QUEEN) | pos.pieces(BLACK, QUEEN)) {
+        return false;
+    }
+    return popCount(pos.occupied()) <= 3;
+}
+
+static GameRecord playGame(const Opening &opening, const Options &options, uint64_t seed) {
+    GameRecord record;
+    ChessEngine engine("", false);
+    if (options.openingBook) {
+        engine.resetBoard(*options.openingBook, options.bookPlies, seed);
+    } else {
+        engine.setFen(opening.start.toFen());
+        for (Move m : opening.moves) {
+            if (!engine.playMove(m)) {
+                break;
+            }
+        }
+    }
+    std::mt19937_64 random(seed);
+    for (int i = 0; i < options.randomPlies && !engine.isGameOver(); i++) {
+        MoveList moves;
+        generateLegalMoves(engine.getPosition(), moves);
+        if (moves.size() == 0 || !engine.playMove(moves.moves[random() % moves.size()])) {
+            break;
+        }
+    }
+
+    TranspositionTable tt(options.hashMB);
+    Search search(tt);
+    std::vector<uint64_t> gameKeys;
+    int resignCount = 0;
+    int drawCount = 0;
+    Color resignLoser = WHITE;
+
+    while (!engine.isGameOver()) {
+        const Position &pos = engine.getPosition();
+        const MoveHistory &history = engine.getHistory();
+        if (insufficientMaterial(pos)) {
+            record.termination = INSUFFICIENT_MATERIAL;
+            break;
+        }
+        if (history.size() >= options.maxPlies) {
+            record.termination = MAX_PLIES;
+            break;
+        }
+
+        gameKeys.clear();
+        for (int i = 0; i < history.size(); i++) {
+            gameKeys.push_back(history.key(i));
+        }
+        SearchResult result = search.think(pos, gameKeys, options.limits);
+        record.nodes += result.nodes;
+        if (!pos.inCheck() && !isCapture(result.bestMove) && !isPromotion(result.bestMove)
+            && std::abs(result.score) < VALUE_MATE_IN_MAX_PLY) {
+            record.positions.push_back(packPosition(pos, result.score));
+        }
+
+        // Both sides have to agree, so count a move only if the previous one said the same
+        int whiteScore = pos.sideToMove() == WHITE ? result.score : -result.score;
+        if (std::abs(whiteScore) >= options.resignScore) {
+            Color loser = whiteScore > 0 ? BLACK : WHITE;
+            resignCount = resignCount > 0 && loser == resignLoser ? resignCount + 1 : 1;
+            resignLoser = loser;
+        } else {
+            resignCount = 0;
+        }
+        drawCount = history.size() >= options.drawAfter && std::abs(whiteScore) <= options.drawScore
+                    ? drawCount + 1 : 0;
+
+        // Only a position without legal moves leaves the search without one, and that ended the game already
+        if (!engine.playMove(result.bestMove)) {
+            break;
+        }
+        if (resignCount >= 2 * options.resignMoves) {
+            record.termination = ADJUDICATED_WIN;
+            record.result = resignLoser == WHITE ? BLACK_WINS : WHITE_WINS;
+            break;
+        }
+        if (drawCount >= 2 * options.drawMoves) {
+            record.termination = ADJUDICATED_DRAW;
+            break;
+        }
+    }
+
+    if (record.termination == BOARD_END) {
+        record.result = parseResult(engine.getResult());
+    } else if (record.termination != ADJUDICATED_WIN) {
+        record.result = DRAW;
+    }
+    for (auto &packed : record.positions) {
+        packed.result = record.result;
+    }
+
+    // Every move since the opening position, book moves included
+    const MoveHistory &history = engine.getHistory();
+    record.start = opening.start;
+    for (int i = 0; i < history.size(); i++) {
+        record.moves.push_back(history.move(i));
+    }
+    return record;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    std::string bookPath, gamesPath, positionsPath, pgnPath;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--games") && i + 1 < argc) {
+            options.games = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--concurrency") && i + 1 < argc) {
+            options.concurrency = (unsigned) std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--nodes") && i + 1 < argc) {
+            options.limits.nodes = (uint64_t) std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--movetime") && i + 1 < argc) {
+            options.limits.moveTime = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--depth") && i + 1 < argc) {
+            options.limits.depth = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--hash") && i + 1 < argc) {
+            options.hashMB = (size_t) std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--book") && i + 1 < argc) {
+            bookPath = argv[++i];
+        } else if (!strcmp(argv[i], "--book-plies") && i + 1 < argc) {
+            options.bookPlies = std::max(0, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--random-plies") && i + 1 < argc) {
+            options.randomPlies = std::max(0, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--max-plies") && i + 1 < argc) {
+            options.maxPlies = std::max(1, std::min(atoi(argv[++i]), 1000));
+        } else if (!strcmp(argv[i], "--resign") && i + 2 < argc) {
+            options.resignScore = atoi(argv[++i]);
+            options.resignMoves = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--draw") && i + 3 < argc) {
+            options.drawScore = atoi(argv[++i]);
+            options.drawMoves = atoi(argv[++i]);
+            options.drawAfter = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--games-out") && i + 1 < argc) {
+            gamesPath = argv[++i];
+        } else if (!strcmp(argv[i], "--positions-out") && i + 1 < argc) {
+            positionsPath = argv[++i];
+        } else if (!strcmp(argv[i], "--pgn") && i + 1 < argc) {
+            pgnPath = argv[++i];
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (!options.limits.nodes && !options.limits.moveTime && !options.limits.depth) {
+        options.limits.nodes = 20000;
+    }
+    // A non-positive move count turns that adjudication off
+    if (options.resignMoves <= 0) options.resignScore = VALUE_INFINITE;
+    if (options.drawMoves <= 0) options.drawScore = -1;
+
+    // A .bin book is walked by weight at the start of every game, other books are lists of openings
+    OpeningBook openingBook;
+    bool binaryBook = bookPath.size() > 4 && bookPath.compare(bookPath.size() - 4, 4, ".bin") == 0;
+    if (binaryBook) {
+        if (!openingBook.open(bookPath)) {
+            fprintf(stderr, "Could not open book: %s\n", openingBook.lastError().c_str());
+            return 1;
+        }
+        options.openingBook = &openingBook;
+    }
+    std::vector<Opening> book;
+    if (!bookPath.empty() && !binaryBook && (!loadBook(bookPath, options.bookPlies, book) || book.empty())) {
+        fprintf(stderr, "Could not read any openings from %s\n", bookPath.c_str());
+        return 1;
+    }
+    if (book.empty()) {
+        book.emplace_back();
+        book.back().start.setStartPosition();
+    }
+
+    GameWriter gamesOut;
+    PositionWriter positionsOut;
+    FILE* pgnOut = nullptr;
+    if ((!gamesPath.empty() && !gamesOut.open(gamesPath))
+        || (!positionsPath.empty() && !positionsOut.open(positionsPath))
+        || (!pgnPath.empty() && !(pgnOut = fopen(pgnPath.c_str(), "wb")))) {
+        fprintf(stderr, "Could not create the output files\n");
+        return 1;
+    }
+
+    printf("Self-play: %d games, %u at a time, %zu openings\n", options.games, options.concurrency, book.size());
+    auto start = std::chrono::steady_clock::now();
+
+    // Every game is one task. Results are collected in game order, so the output files
+    // do not depend on which worker finished first
+    std::vector<std::future<GameRecord>> pending;
+    {
+        ThreadPool pool(options.concurrency);
+        pending.reserve(options.games);
+        for (int i = 0; i < options.games; i++) {
+            const Opening &opening = book[i % book.size()];
+            uint64_t seed = options.seed * 0x9E3779B97F4A7C15ULL + i;
+            pending.push_back(pool.submit([&opening, &options, seed] {
+                return playGame(opening, options, seed);
+            }));
+        }
+
+        int results[4] = {};
+        int terminations[TERMINATION_COUNT] = {};
+        uint64_t plies = 0, nodes = 0, positions = 0;
+        std::string pgn;
+        for (int i = 0; i < options.games; i++) {
+            GameRecord game = pending[i].get();
+            results[game.result]++;
+            terminations[game.termination]++;
+            plies += game.moves.size();
+            nodes += game.nodes;
+            positions += game.positions.size();
+
+            if (!gamesPath.empty()) {
+                gamesOut.addGame(game.start, game.moves.data(), (int) game.moves.size(), game.result);
+            }
+            if (!positionsPath.empty()) {
+                positionsOut.write(game.positions.data(), game.positions.size());
+            }
+            if (pgnOut) {
+                std::string round = std::to_string(i + 1);
+                const char* result = resultToPgn(game.result);
+                std::vector<PgnTag> tags = {{"Event", "chess-selfplay"}, {"Round", round}, {"White", "ChessSim"},
+                                            {"Black", "ChessSim"}, {"Result", result},
+                                            {"Termination", TERMINATION_NAMES[game.termination]}};
+                pgn.clear();
+                writePgn(pgn, tags, game.start, game.moves, result);
+                fwrite(pgn.data(), 1, pgn.size(), pgnOut);
+            }
+
+            int done = i + 1;
+            if (done % std::max(1, options.games / 20) == 0 || done == options.games) {
+                double hours = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / 3600;
+                printf("  %6d games  +%d =%d -%d  %.0f games/hour  %.0f knps\n", done, results[WHITE_WINS],
+                       results[DRAW], results[BLACK_WINS], done / hours, nodes / (hours * 3600) / 1000);
+                fflush(stdout);
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("Finished %d games in %.1f s: %.0f games/hour, %.1f plies/game, %llu positions\n", options.games,
+               seconds, options.games * 3600 / seconds, (double) plies / options.games,
+               (unsigned long long) positions);
+        printf("  white wins %d, draws %d, black wins %d\n", results[WHITE_WINS], results[DRAW], results[BLACK_WINS]);
+        for (int t = 0; t < TERMINATION_COUNT; t++) {
+            printf("  %-22s %d\n", TERMINATION_NAMES[t], terminations[t]);
+        }
+    }
+
+    bool ok = gamesOut.close() && positionsOut.close();
+    if (pgnOut) {
+        ok = fclose(pgnOut) == 0 && ok;
+    }
+    if (!ok) {
+        fprintf(stderr, "Could not write the output files\n");
+        return 1;
+    }
+    return 0;
+}
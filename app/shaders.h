@@ -7,8 +7,28 @@
 
 #include "string"
 
+/**
+ * Camera and light, the same for every shader and every draw of a frame. All shaders
+ * declare this block at binding 0 and ChessApp fills it once per frame from a
+ * FrameUniforms struct, which has to match the std140 layout below.
+ */
+const std::string frameUniformBlock = R"(
+    layout (std140, binding = 0) uniform FrameData
+    {
+        mat4 u_viewMat;
+        mat4 u_projMat;
+        mat4 u_viewProjMat;
+        vec3 u_cameraPosition;
+        float u_diffuseStrength;
+        vec3 u_lightSourcePosition;
+        float u_specularStrength;
+        vec3 u_lightColor;
+    };
+)";
+
 const std::string gridVertexShader = R"(
     #version 460 core
+)" + frameUniformBlock + R"(
 
     layout (location = 0) in vec2 position;
 
@@ -16,8 +36,6 @@ const std::string gridVertexShader = R"(
     out vec2 positions;
     out vec3 Normal;
 
-    uniform mat4 u_projMat;
-    uniform mat4 u_viewMat;
     uniform mat4 u_modMat;
     uniform vec3 u_normals;
 
@@ -34,6 +52,7 @@ const std::string gridVertexShader = R"(
 
 const std::string gridFragmentShader = R"(
 	#version 460 core
+)" + frameUniformBlock + R"(
 
     #define M_PI 3.141592653589
 
@@ -51,11 +70,6 @@ const std::string gridFragmentShader = R"(
 
     //Lighting
     uniform float u_ambientStrength;
-    uniform vec3 u_lightSourcePosition;
-    uniform float u_diffuseStrength;
-    uniform vec3 u_lightColor;
-    uniform vec3 u_cameraPosition;
-    uniform float u_specularStrength;
 
     layout(binding=1) uniform sampler2D u_lightTextureSampler;
 
@@ -120,6 +134,7 @@ const std::string gridFragmentShader = R"(
 
 std::string cubeFragmentShader = R"(
     #version 460 core
+)" + frameUniformBlock + R"(
 
     in vec3 vs_texPos;
     in vec3 vs_fragPosition;
@@ -131,13 +146,6 @@ std::string cubeFragmentShader = R"(
     uniform int u_texture;
     uniform float u_ambientStrength;
     uniform bool u_whitePiece;
-
-    uniform vec3 u_cameraPosition;
-    uniform float u_specularStrength;
-
-    uniform vec3 u_lightSourcePosition;
-    uniform float u_diffuseStrength;
-    uniform vec3 u_lightColor;
     uniform int u_shine;
 
     layout(binding = 2) uniform samplerCube u_darkWoodCube;
@@ -178,6 +186,7 @@ std::string cubeFragmentShader = R"(
 
 std::string cubeVertexShader = R"(
     #version 460 core
+)" + frameUniformBlock + R"(
 
     layout (location = 0) in vec3 position;
     layout (location = 1) in vec3 normals;
@@ -186,7 +195,6 @@ std::string cubeVertexShader = R"(
     out vec3 vs_fragPosition;
     out vec3 Normal;
 
-    uniform mat4 u_viewProjMat;
     uniform mat4 u_model;
 
     void main(){
@@ -197,4 +205,89 @@ std::string cubeVertexShader = R"(
     }
 )";
 
+/**
+ * Chess pieces are drawn instanced, one draw per piece type. Model matrix, color
+ * and flags come from the instance buffer instead of uniforms, the rest of the
+ * lighting matches the cube shader.
+ */
+std::string pieceVertexShader = R"(
+    #version 460 core
+)" + frameUniformBlock + R"(
+
+    layout (location = 0) in vec3 position;
+    layout (location = 1) in vec3 normals;
+    layout (location = 3) in mat4 i_model;     // Takes locations 3-6
+    layout (location = 7) in vec4 i_color;
+    layout (location = 8) in vec2 i_flags;     // x: white piece, y: selected
+
+    out vec3 vs_texPos;
+    out vec3 vs_fragPosition;
+    out vec3 Normal;
+    out vec4 vs_color;
+    flat out int vs_white;
+
+    uniform vec4 u_selectedColor;
+
+    void main(){
+        gl_Position = u_viewProjMat * i_model * vec4(position,1.0f);
+        vs_texPos = position;
+        Normal = normals;
+        vs_fragPosition = vec3(i_model * vec4(position, 1.0f));
+        vs_color = i_flags.y > 0.5 ? u_selectedColor : i_color;
+        vs_white = i_flags.x > 0.5 ? 1 : 0;
+    }
+)";
+
+std::string pieceFragmentShader = R"(
+    #version 460 core
+)" + frameUniformBlock + R"(
+
+    in vec3 vs_texPos;
+    in vec3 vs_fragPosition;
+    in vec3 Normal;
+    in vec4 vs_color;
+    flat in int vs_white;
+
+    out vec4 finalColor;
+
+    uniform int u_texture;
+    uniform float u_ambientStrength;
+    uniform int u_shine;
+
+    layout(binding = 2) uniform samplerCube u_darkWoodCube;
+    layout(binding = 3) uniform samplerCube u_lightWoodCube;
+
+    void main()
+    {
+        //Ambient color
+        vec3 ambient = u_ambientStrength * u_lightColor;
+
+        //Textures
+        if(u_texture == 1)
+        {
+            finalColor = mix(vs_color,texture(u_lightWoodCube, vs_texPos),vs_white == 1 ? 0.8 : 0.4);
+        } else {
+            finalColor = vs_color;
+        }
+
+        //Diffuse
+        vec3 norm = normalize(Normal);
+        vec3 lightDirection = normalize(u_lightSourcePosition - vs_fragPosition);
+        float diffuseStrength = max(dot(norm, lightDirection),0) * u_diffuseStrength;
+        vec3 diffuse = diffuseStrength * u_lightColor;
+
+        //Specular
+        vec3 viewDir = normalize(u_cameraPosition - vs_fragPosition);
+        vec3 reflectedLight = reflect(-lightDirection, norm);
+        float specFactor = pow(max(dot(viewDir, reflectedLight), 0.0f), u_shine);
+        float spec = specFactor * u_specularStrength;
+        vec3 specular = spec * u_lightColor;
+
+        //Combine results
+        vec3 fRGB = vec3(finalColor.r,finalColor.g,finalColor.b);
+        fRGB *= specular + ambient + diffuse;
+        finalColor = vec4(fRGB,finalColor.z);
+    }
+)";
+
 #endif //PROG2002_SHADERS_H
@@ -0,0 +1,172 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MoveGen.h"
+#include "Notation.h"
+#include "Position.h"
+#include "Tablebase.h"
+
+static void printUsage() {
+    printf("Usage: chess-tbgen [options] [table ...]\n"
+           "  table            Material to solve, e.g. KRvK or KQPvKQ; the tables its captures and\n"
+           "                   promotions lead to are generated first if missing\n"
+           "  --dir <dir>      Directory the tables are read from and written to (default .)\n"
+           "  --pieces <n>     Generate every table with up to n pieces, kings included\n"
+           "  --threads <n>    Worker threads (default: all cores)\n"
+           "  --probe <fen>    Print the tablebase result of a position and of each of its moves\n");
+}
+
+static void printLine(const std::string &line) {
+    printf("  %s\n", line.c_str());
+    fflush(stdout);
+}
+
+static std::string describe(const TbResult &result) {
+    if (result.wdl == 0) {
+        return "draw";
+    }
+    return std::string(result.wdl > 0 ? "win" : "loss") + ", mate in " + std::to_string(result.dtm) + " plies";
+}
+
+// Adds every table with exactly `pieces` pieces besides the kings to names
+static void enumerate(int pieces, std::vector<std::string> &names) {
+    const char letters[] = "QRBNP";
+    // Each piece is one of five types on one of two sides: count through all assignments
+    std::vector<int> choice((size_t) pieces, 0);
+    for (;;) {
+        std::string sides[2] = {"K", "K"};
+        for (int c : choice) {
+            sides[c / 5] += letters[c % 5];
+        }
+        std::string name = Tablebases::normalize(sides[0] + "v" + sides[1]);
+        if (std::find(names.begin(), names.end(), name) == names.end()) {
+            names.push_back(name);
+        }
+        int i = 0;
+        while (i < pieces && ++choice[i] == 10) {
+            choice[i++] = 0;
+        }
+        if (i == pieces) {
+            break;
+        }
+    }
+}
+
+static bool exists(const std::string &path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file) {
+        fclose(file);
+    }
+    return file != nullptr;
+}
+
+// Generates name after the tables it depends on, skipping tables that already have a file
+static bool ensure(const std::string &name, const std::string &directory, unsigned threads, Tablebases &tablebases,
+                   std::set<std::string> &done) {
+    if (name == "KvK" || done.count(name) || exists(directory + "/" + name + ".ctb")) {
+        return true;
+    }
+    for (const std::string &sub : Tablebases::subtables(name)) {
+        if (!ensure(sub, directory, threads, tablebases, done)) {
+            return false;
+        }
+    }
+    // The tables just written have to be visible to this one
+    tablebases.init(directory);
+    printf("%s\n", name.c_str());
+    auto start = std::chrono::steady_clock::now();
+    if (!Tablebases::generate(name, directory, tablebases, threads, printLine)) {
+        printf("  failed\n");
+        return false;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("  done in %.1f s\n", seconds);
+    done.insert(name);
+    return true;
+}
+
+static int probe(const std::string &fen, const std::string &directory) {
+    Position pos;
+    if (!pos.setFromFen(fen)) {
+        fprintf(stderr, "Invalid FEN: %s\n", fen.c_str());
+        return 2;
+    }
+    Tablebases tablebases;
+    tablebases.init(directory);
+    TbResult result;
+    if (!tablebases.probe(pos, result)) {
+        printf("not in the tablebases in %s\n", directory.c_str());
+        return 1;
+    }
+    printf("%s\n", describe(result).c_str());
+    MoveList moves;
+    generateLegalMoves(pos, moves);
+    for (Move m : moves) {
+        Position child = pos;
+        UndoRecord undo;
+        child.makeMove(m, undo);
+        TbResult childResult;
+        if (tablebases.probe(child, childResult)) {
+            printf("  %-6s %s\n", moveToUci(m).c_str(), describe(childResult).c_str());
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string directory = ".";
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int pieces = 0;
+    std::string probeFen;
+    std::vector<std::string> names;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--dir") && i + 1 < argc) {
+            directory = argv[++i];
+        } else if (!strcmp(argv[i], "--pieces") && i + 1 < argc) {
+            pieces = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = (unsigned) std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--probe") && i + 1 < argc) {
+            probeFen = argv[++i];
+        } else if (argv[i][0] != '-' && !Tablebases::normalize(argv[i]).empty()) {
+            names.push_back(Tablebases::normalize(argv[i]));
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (!probeFen.empty()) {
+        return probe(probeFen, directory);
+    }
+    if (pieces > TB_MAX_PIECES) {
+        fprintf(stderr, "Tables have at most %d pieces\n", TB_MAX_PIECES);
+        return 2;
+    }
+    for (int n = 1; n <= pieces - 2; n++) {
+        enumerate(n, names);
+    }
+    if (names.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    Tablebases tablebases;
+    std::set<std::string> done;
+    for (const std::string &name : names) {
+        if (!ensure(name, directory, threads, tablebases, done)) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,13 @@
+//
+// Created by larsm on 17.10.2026.
+//
+
+#include <iostream>
+#include "Uci.h"
+
+int main() {
+    std::ios::sync_with_stdio(false);
+    Uci uci;
+    uci.loop();
+    return 0;
+}
@@ -5,7 +5,7 @@
 
 	// Constructor. It initializes with a data buffer and the size of it.
 	// Note that the buffer will be bound on construction.
-IndexBuffer::IndexBuffer(unsigned int *indices, unsigned int count) {
+IndexBuffer::IndexBuffer(const unsigned int *indices, unsigned int count) {
 	Count = count;
 	glGenBuffers(1, &IndexBufferID);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IndexBufferID);
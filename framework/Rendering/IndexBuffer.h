@@ -11,7 +11,7 @@ private:
 public:
 	// Constructor. It initializes with a data buffer and the size of it.
 	// Note that the buffer will be bound on construction.
-	IndexBuffer(unsigned int *indices, unsigned int count);
+	IndexBuffer(const unsigned int *indices, unsigned int count);
 	~IndexBuffer();
 
 	// Bind the vertex buffer
@@ -11,9 +11,11 @@
 Shader::Shader(const std::string vertexShader, const std::string fragmentShader)
 {
     ID = compileShader(vertexShader,fragmentShader);
+    CacheUniformLocations();
 }
 
 Shader::~Shader() {
+    glDeleteProgram(ID);
 }
 
 // use/activate the shader
@@ -22,45 +24,73 @@ void Shader::use() {
 }
 
 // utility uniform functions
-void Shader::setBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+void Shader::setBool(UniformName name, bool value) const {
+    glUniform1i(GetUniformLocation(name), (int)value);
 }
 
-void Shader::setInt(const std::string& name, int value) const {
+void Shader::setInt(UniformName name, int value) const {
     glUniform1i(GetUniformLocation(name), value);
 }
 
-void Shader::setFloat(const std::string& name, float value) const {
+void Shader::setFloat(UniformName name, float value) const {
     glUniform1f(GetUniformLocation(name), value);
 }
 
-void Shader::setUniform4f(const std::string& name, glm::vec4 v) const {
+void Shader::setUniform4f(UniformName name, glm::vec4 v) const {
     glUniform4f(GetUniformLocation(name), v[0], v[1], v[2], v[3]);
 }
 
-void Shader::setUniform3f(const std::string& name, glm::vec3 v) const {
+void Shader::setUniform3f(UniformName name, glm::vec3 v) const {
     glUniform3f(GetUniformLocation(name), v[0], v[1], v[2]);
 }
 
-void Shader::setUniform2f(const std::string& name, glm::vec2 v) const {
+void Shader::setUniform2f(UniformName name, glm::vec2 v) const {
     glUniform2f(GetUniformLocation(name), v.x, v.y);
 }
-void Shader::setUInt(const std::string &name, unsigned int value) const {
+void Shader::setUInt(UniformName name, unsigned int value) const {
     glUniform1ui(GetUniformLocation(name), value);
 }
 
-void Shader::setMat4(const std::string& name, const glm::mat4& mat) const {
+void Shader::setMat4(UniformName name, const glm::mat4& mat) const {
     glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
-void Shader::setDouble(const char *string, double d) const{
-    glUniform1d(GetUniformLocation(string), d);
+void Shader::setDouble(UniformName name, double d) const{
+    glUniform1d(GetUniformLocation(name), d);
 }
 
-int Shader::GetUniformLocation(const std::string& name) const {
-     int loc = glGetUniformLocation(ID, name.c_str());
-     if (loc == -1)
-         std::cout << "WARNING: uniform '" << name << "' can't be found!" << std::endl;
-     return loc;
+int Shader::GetUniformLocation(UniformName name) const {
+     auto it = Locations.find(name.Hash);
+     if (it != Locations.end())
+         return it->second;
+     std::cout << "WARNING: uniform '" << name.Name << "' can't be found!" << std::endl;
+     Locations.emplace(name.Hash, -1);
+     return -1;
+}
+
+// Queries the location of every active uniform once, so that setting one is a lookup by hash
+void Shader::CacheUniformLocations() {
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<GLchar> name(maxLength + 1);
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, i, (GLsizei)name.size(), &length, &size, &type, name.data());
+        int location = glGetUniformLocation(ID, name.data());
+        // Members of uniform blocks have no location, they are set through the block's buffer
+        if (location == -1)
+            continue;
+        // Arrays are reported as "name[0]", they are set by their plain name
+        std::string uniform(name.data(), length);
+        if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+            uniform.resize(uniform.size() - 3);
+        auto inserted = Locations.emplace(UniformName::HashName(uniform.c_str()), location);
+        if (!inserted.second)
+            std::cout << "WARNING: uniform '" << uniform << "' has the same hash as another uniform!" << std::endl;
+    }
 }
 
 GLuint Shader::compileShader(const std::string& vertexShader, const std::string &fragmentShader) {
@@ -6,14 +6,40 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <cstdint>
+#include <unordered_map>
 #include <glm/glm.hpp>
 
+// Name of a uniform together with its FNV-1a hash. Built from a string
+// literal the hash is a constant expression, so a set* call with a literal
+// name costs one hash map lookup and no string handling.
+struct UniformName
+{
+    uint32_t Hash;
+    const char* Name;
+
+    constexpr UniformName(const char* name) : Hash(HashName(name)), Name(name) {}
+    UniformName(const std::string& name) : Hash(HashName(name.c_str())), Name(name.c_str()) {}
+
+    static constexpr uint32_t HashName(const char* name)
+    {
+        uint32_t hash = 2166136261u;
+        for (; *name; name++) {
+            hash = (hash ^ (uint8_t)*name) * 16777619u;
+        }
+        return hash;
+    }
+};
+
 
 class Shader
 {
 private: 
     
-    unsigned int ID;
+    unsigned int ID = 0;
+    // Location of every uniform by name hash, filled once the program is linked.
+    // Names asked for but not in the program are added with -1 and reported once.
+    mutable std::unordered_map<uint32_t, int> Locations;
 
 public:
     // constructor reads and builds the shader
@@ -25,18 +51,19 @@ public:
         void use();
     // utility uniform functions
         int retID() const {return ID;}
-        void setBool(const std::string& name, bool value) const;
-        void setInt(const std::string& name, int value) const;
-        void setUInt(const std::string& name, unsigned int value) const;
-        void setFloat(const std::string& name, float value) const;
-        void setMat4(const std::string& name, const glm::mat4& mat)const;
-        void setUniform4f(const std::string& name, glm::vec4 v) const;
-        void setUniform3f(const std::string& name, glm::vec3 v) const;
-        void setUniform2f(const std::string& name, glm::vec2 v) const;
-        void setDouble(const char *string, double d) const;
+        void setBool(UniformName name, bool value) const;
+        void setInt(UniformName name, int value) const;
+        void setUInt(UniformName name, unsigned int value) const;
+        void setFloat(UniformName name, float value) const;
+        void setMat4(UniformName name, const glm::mat4& mat)const;
+        void setUniform4f(UniformName name, glm::vec4 v) const;
+        void setUniform3f(UniformName name, glm::vec3 v) const;
+        void setUniform2f(UniformName name, glm::vec2 v) const;
+        void setDouble(UniformName name, double d) const;
 
 private:
-    int GetUniformLocation(const std::string& name) const;
+    int GetUniformLocation(UniformName name) const;
+    void CacheUniformLocations();
     static GLuint compileShader(const std::string& vertexShader, const std::string& fragmentShader);
 };
 
@@ -6,96 +6,105 @@
 
 bool TextureManager::LoadTexture2DRGBA(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap)
 {
-    int width, height, bpp;
-    auto data = this->LoadTextureImage(filePath, width, height, bpp, STBI_rgb_alpha);
-
-    if (!data)
+    Image image = DecodeImageRGBA(filePath);
+    if (!image.data)
     {
         return false;
     }
+    AddTexture(name, filePath, image, unit, mipMap, Texture2D);
+    return true;
+}
 
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glActiveTexture(GL_TEXTURE0 + unit); // Texture Unit
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-    if (mipMap)
+bool TextureManager::LoadTexture2DRGBA(const std::string& name, const Image& image, GLuint unit, bool mipMap)
+{
+    if (!image.data)
     {
-        glGenerateMipmap(GL_TEXTURE_2D);
+        return false;
     }
-
-    // Wrapping
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // Filtering
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    Texture texture;
-    texture.mipMap = mipMap;
-    texture.width = width;
-    texture.height = height;
-    texture.name = name;
-    texture.filePath = filePath;
-    texture.unit = unit;
-    texture.type = Texture2D;
-
-    this->Textures.push_back(texture);
-
-    this->FreeTextureImage(data);
-
+    AddTexture(name, "", image, unit, mipMap, Texture2D);
     return true;
 }
 
 bool TextureManager::LoadCubeMapRGBA(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap)
 {
-    int width, height, bpp;
-    auto data = this->LoadTextureImage(filePath, width, height, bpp, STBI_rgb_alpha);
+    Image image = DecodeImageRGBA(filePath);
+    if (!image.data)
+    {
+        return false;
+    }
+    AddTexture(name, filePath, image, unit, mipMap, CubeMap);
+    return true;
+}
 
-    if (!data)
+bool TextureManager::LoadCubeMapRGBA(const std::string& name, const Image& image, GLuint unit, bool mipMap)
+{
+    if (!image.data)
     {
         return false;
     }
+    AddTexture(name, "", image, unit, mipMap, CubeMap);
+    return true;
+}
 
+void TextureManager::AddTexture(const std::string& name, const std::string& filePath, const Image& image, GLuint unit, bool mipMap, TextureType type)
+{
     /*Generate a texture object and upload the loaded image to it.*/
+    GLenum target = type == CubeMap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
     GLuint tex;
     glGenTextures(1, &tex);
     glActiveTexture(GL_TEXTURE0 + unit); // Texture Unit
-    glBindTexture(GL_TEXTURE_CUBE_MAP, tex);
+    glBindTexture(target, tex);
 
-    for (unsigned int i = 0; i < 6; i++) {
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    if (type == CubeMap)
+    {
+        for (unsigned int i = 0; i < 6; i++) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.data.get());
+        }
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.data.get());
     }
 
     if (mipMap)
     {
-        glGenerateMipmap(GL_TEXTURE_2D);
+        glGenerateMipmap(target);
     }
 
     // Wrapping
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    if (type == CubeMap)
+    {
+        glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    }
     // Filtering
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     Texture texture;
     texture.mipMap = mipMap;
-    texture.width = width;
-    texture.height = height;
+    texture.width = image.width;
+    texture.height = image.height;
     texture.name = name;
     texture.filePath = filePath;
     texture.unit = unit;
-    texture.type = CubeMap;
+    texture.type = type;
 
     this->Textures.push_back(texture);
-    this->FreeTextureImage(data);
-
-    return true;
 }
 
+TextureManager::Image TextureManager::DecodeImageRGBA(const std::string& filePath)
+{
+    Image image;
+    int bpp;
+    unsigned char* data = stbi_load(filePath.c_str(), &image.width, &image.height, &bpp, STBI_rgb_alpha);
+    if (data)
+    {
+        image.data = std::shared_ptr<unsigned char>(data, stbi_image_free);
+    }
+    return image;
+}
 
 GLuint TextureManager::GetUnitByName(const std::string& name) const
 {
@@ -108,17 +117,3 @@ GLuint TextureManager::GetUnitByName(const std::string& name) const
     }
     return -1;
 }
-
-unsigned char* TextureManager::LoadTextureImage(const std::string& filepath, int& width, int& height, int& bpp, int format) const
-{
-    return stbi_load(filepath.c_str(), &width, &height, &bpp, format);
-}
-
-
-void TextureManager::FreeTextureImage(unsigned char* data) const
-{
-    if (data)
-    {
-        stbi_image_free(data);
-    }
-}
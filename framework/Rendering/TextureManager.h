@@ -7,6 +7,7 @@
 #include <stb_image.h>
 
 // STD includes
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -26,6 +27,13 @@ public:
         TextureManager::TextureType type;
     };
 
+    // Decoded RGBA8 pixels of an image file, freed with the last copy
+    struct Image
+    {
+        int width = 0, height = 0;
+        std::shared_ptr<unsigned char> data;
+    };
+
 public:
     static TextureManager* GetInstance()
     {return TextureManager::Instance != nullptr?TextureManager::Instance: TextureManager::Instance = new TextureManager(); }
@@ -33,11 +41,16 @@ public:
 public:
     bool LoadTexture2DRGBA(const std::string& name, const std::string& filepath, GLuint unit, bool mipMap=true);
     bool LoadCubeMapRGBA(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap=true);
+    // Same as above with an image decoded beforehand, for loaders that decode on other threads
+    bool LoadTexture2DRGBA(const std::string& name, const Image& image, GLuint unit, bool mipMap=true);
+    bool LoadCubeMapRGBA(const std::string& name, const Image& image, GLuint unit, bool mipMap=true);
     GLuint GetUnitByName(const std::string& name) const;
 
+    // Decodes an image file without touching OpenGL, so it can run on any thread. data is null on failure
+    static Image DecodeImageRGBA(const std::string& filePath);
+
 private:
-    unsigned char* LoadTextureImage(const std::string& filepath, int& width, int& height, int& bpp, int format)const;
-    void FreeTextureImage(unsigned char* data) const;
+    void AddTexture(const std::string& name, const std::string& filePath, const Image& image, GLuint unit, bool mipMap, TextureType type);
 
 private:
     TextureManager(){};
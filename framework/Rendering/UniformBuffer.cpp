@@ -0,0 +1,33 @@
+#include <glad/glad.h>
+#include "UniformBuffer.h"
+
+
+	// Constructor. It allocates size bytes and binds the buffer to the given
+	// uniform block binding point.
+UniformBuffer::UniformBuffer(GLsizeiptr size, GLuint binding) {
+	Binding = binding;
+	glGenBuffers(1, &UniformBufferID);
+	glBindBuffer(GL_UNIFORM_BUFFER, UniformBufferID);
+	glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, binding, UniformBufferID);
+}
+
+UniformBuffer::~UniformBuffer() {
+	glDeleteBuffers(1, &UniformBufferID);
+}
+
+	// Bind the uniform buffer
+void UniformBuffer::Bind() const {
+	glBindBuffer(GL_UNIFORM_BUFFER, UniformBufferID);
+}
+
+	// Unbind the uniform buffer
+void UniformBuffer::Unbind() const {
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+	// Fill out a specific segment of the buffer given by an offset and a size.
+void UniformBuffer::BufferSubData(GLintptr offset, GLsizeiptr size, const void* data) const {
+	glBindBuffer(GL_UNIFORM_BUFFER, UniformBufferID);
+	glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+}
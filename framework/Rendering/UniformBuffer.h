@@ -0,0 +1,32 @@
+#ifndef UNIFORMBUFFER_H_
+#define UNIFORMBUFFER_H_
+
+#include <glad/glad.h>
+
+class UniformBuffer
+{
+public:
+	// Constructor. It allocates size bytes and binds the buffer to the given
+	// uniform block binding point, where every shader declaring a block with
+	// layout(std140, binding = ...) reads it from.
+	UniformBuffer(GLsizeiptr size, GLuint binding);
+	~UniformBuffer();
+
+	// Bind the uniform buffer
+	void Bind() const;
+
+	// Unbind the uniform buffer
+	void Unbind() const;
+
+	// Fill out a specific segment of the buffer given by an offset and a size.
+	void BufferSubData(GLintptr offset, GLsizeiptr size, const void* data) const;
+
+	// Get the binding point
+	inline GLuint GetBinding() const { return Binding; }
+
+private:
+	GLuint UniformBufferID;
+	GLuint Binding;
+};
+
+#endif // UNIFORMBUFFER_H_
@@ -1,4 +1,5 @@
 #include <glad/glad.h>
+#include <cstdint>
 #include "VertexBuffer.h"
 #include "BufferLayout.h"
 #include "VertexArray.h"
@@ -30,12 +31,20 @@
 		vertexBuffer->Bind();
 		const auto& layout = vertexBuffer->GetLayout();
 		const auto& elements = layout.GetAttributes();
-		for (int i = 0; i < elements.size(); i++) {
-			const auto& element = elements[i];
+		for (const auto& element : elements) {
 			const auto type = ShaderDataTypeToOpenGLBaseType(element.Type);
-			const auto size = ShaderDataTypeComponentCount(element.Type);
-			glEnableVertexAttribArray(i);
-			glVertexAttribPointer(i, size, type, element.Normalized, layout.GetStride(), reinterpret_cast<const void *>(element.Offset));
+			// Matrices take one attribute location per column
+			GLuint columns = 1;
+			if (element.Type == ShaderDataType::Mat3) columns = 3;
+			if (element.Type == ShaderDataType::Mat4) columns = 4;
+			const auto size = ShaderDataTypeComponentCount(element.Type) / columns;
+			for (GLuint column = 0; column < columns; column++) {
+				const auto offset = element.Offset + column * size * sizeof(float);
+				glEnableVertexAttribArray(NextAttributeIndex);
+				glVertexAttribPointer(NextAttributeIndex, size, type, element.Normalized, layout.GetStride(), reinterpret_cast<const void *>((uintptr_t)offset));
+				glVertexAttribDivisor(NextAttributeIndex, vertexBuffer->GetDivisor());
+				NextAttributeIndex++;
+			}
 		}
 
 		VertexBuffers.push_back(vertexBuffer);
@@ -21,7 +21,8 @@ public:
 
 	// Add vertex buffer. This method utilizes the BufferLayout internal to 
 	// the vertex buffer to set up the vertex attributes. Notice that 
-	// this function opens for the definition of several vertex buffers.
+	// this function opens for the definition of several vertex buffers:
+	// their attributes take consecutive locations in the order they are added.
 	void AddVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuffer);
 	// Set index buffer
 	void SetIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer);
@@ -31,6 +32,7 @@ public:
 
 private:
 	GLuint m_vertexArrayID;
+	GLuint NextAttributeIndex = 0;
 	std::vector<std::shared_ptr<VertexBuffer>> VertexBuffers;
 	std::shared_ptr<IndexBuffer> IdxBuffer;
 
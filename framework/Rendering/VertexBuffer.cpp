@@ -4,10 +4,10 @@
 
 	// Constructor. It initializes with a data buffer and the size of it.
 	// Note that the buffer will be bound on construction.
-VertexBuffer::VertexBuffer(const void *vertices, GLsizei size) {
+VertexBuffer::VertexBuffer(const void *vertices, GLsizeiptr size, GLenum usage) {
 	glGenBuffers(1, &VertexBufferID);
 	glBindBuffer(GL_ARRAY_BUFFER, VertexBufferID);
-	glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, size, vertices, usage);
 }
 
 VertexBuffer::~VertexBuffer() {
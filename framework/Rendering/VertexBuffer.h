@@ -8,14 +8,19 @@ class VertexBuffer
 {
 public:
 	// Constructor. It initializes with a data buffer and the size of it.
-	// Note that the buffer will be bound on construction.
-	VertexBuffer(const void* vertices, GLsizei size);
+	// Note that the buffer will be bound on construction. Buffers rewritten
+	// while drawing, like per-instance data, pass GL_DYNAMIC_DRAW as usage.
+	VertexBuffer(const void* vertices, GLsizeiptr size, GLenum usage = GL_STATIC_DRAW);
 	~VertexBuffer();
 
 	// Set/Get buffer layout
 	const BufferLayout& GetLayout() const { return Layout; }
 	void SetLayout(const BufferLayout& layout) { Layout = layout; }
 
+	// Set/Get the attribute divisor: 0 advances the attributes per vertex, 1 per instance
+	GLuint GetDivisor() const { return Divisor; }
+	void SetDivisor(GLuint divisor) { Divisor = divisor; }
+
 
 	// Bind the vertex buffer
 	void Bind() const;
@@ -29,6 +34,7 @@ public:
 private:
 	GLuint VertexBufferID;
 	BufferLayout Layout;
+	GLuint Divisor = 0;
 };
 
 #endif // VERTEXBUFFER_H_